@@ -0,0 +1,129 @@
+﻿#include "AlgorithmTrace.h"
+
+void AlgorithmTrace::append(const AlgorithmStep& step)
+{
+    PackedStep packed;
+    packed.type = quint8(step.type);
+    packed.color = paletteIndex(step.color.rgba());
+    packed.reserved = 0;
+    packed.index = step.index < 0 ? NoIndex : quint32(step.index);
+
+    writableChunk().push_back(packed);
+    m_size++;
+}
+
+void AlgorithmTrace::append(const AlgorithmTrace& other)
+{
+    // Дописать саму себя: блоки источника переезжали бы при росте - копируем заранее
+    if (&other == this) {
+        const AlgorithmTrace copy = other;
+        append(copy);
+        return;
+    }
+
+    // Чужую палитру переводим в свою один раз. Дальше шаги копируются кусками блоков
+    // с заменой байта цвета по таблице - без распаковки в QColor и поиска в палитре
+    quint8 remap[256] = {};
+    for (int i = 0; i < int(other.m_palette.size()); ++i) {
+        remap[i] = paletteIndex(other.m_palette[i]);
+    }
+
+    for (const std::vector<PackedStep>& source : other.m_chunks) {
+        for (size_t done = 0; done < source.size(); ) {
+            std::vector<PackedStep>& target = writableChunk();
+            const size_t first = target.size();
+            const size_t n = qMin(size_t(ChunkSize) - first, source.size() - done);
+
+            target.insert(target.end(), source.begin() + done, source.begin() + done + n);
+            for (size_t k = first; k < target.size(); ++k) {
+                target[k].color = remap[target[k].color];
+            }
+            done += n;
+        }
+    }
+    m_size += other.m_size;
+}
+
+AlgorithmStep AlgorithmTrace::at(qsizetype i) const
+{
+    const PackedStep& packed = m_chunks[size_t(i >> ChunkShift)][size_t(i & (ChunkSize - 1))];
+
+    AlgorithmStep step;
+    step.type = StepType(packed.type);
+    step.index = packed.index == NoIndex ? -1 : int(packed.index);
+    step.color = QColor::fromRgba(m_palette[packed.color]);
+    return step;
+}
+
+void AlgorithmTrace::clear()
+{
+    m_chunks.clear();
+    m_size = 0;
+    m_palette.clear();
+    m_lastColor = -1;
+}
+
+qsizetype AlgorithmTrace::memoryUsage() const
+{
+    qsizetype bytes = qsizetype(m_chunks.capacity() * sizeof(std::vector<PackedStep>));
+    for (const std::vector<PackedStep>& chunk : m_chunks) {
+        bytes += qsizetype(chunk.capacity() * sizeof(PackedStep));
+    }
+    return bytes + m_palette.size() * qsizetype(sizeof(QRgb));
+}
+
+AlgorithmTrace AlgorithmTrace::fromPacked(const PackedStep* steps, qsizetype count, const QRgb* palette, int paletteSize)
+{
+    AlgorithmTrace trace;
+    if (paletteSize <= 0) return trace;
+
+    for (int i = 0; i < paletteSize && i < 256; ++i) {
+        trace.m_palette.append(palette[i]);
+    }
+    const quint8 lastColor = quint8(trace.m_palette.size() - 1);
+
+    // Блоки заполняем целиком, без распаковки шагов
+    for (qsizetype done = 0; done < count; ) {
+        const qsizetype n = qMin(ChunkSize, count - done);
+
+        trace.m_chunks.emplace_back(steps + done, steps + done + n);
+        trace.m_chunks.back().reserve(ChunkSize);
+        for (PackedStep& step : trace.m_chunks.back()) {
+            if (step.color > lastColor) step.color = lastColor;
+        }
+
+        done += n;
+    }
+    trace.m_size = count;
+    return trace;
+}
+
+std::vector<PackedStep>& AlgorithmTrace::writableChunk()
+{
+    if (m_chunks.empty() || m_chunks.back().size() == size_t(ChunkSize)) {
+        m_chunks.emplace_back();
+        m_chunks.back().reserve(ChunkSize);
+    }
+    return m_chunks.back();
+}
+
+quint8 AlgorithmTrace::paletteIndex(QRgb rgba)
+{
+    if (m_lastColor >= 0 && m_palette[m_lastColor] == rgba) {
+        return quint8(m_lastColor);
+    }
+
+    int index = int(m_palette.indexOf(rgba));
+    if (index < 0) {
+        // Алгоритмы используют единицы цветов; если палитра все же переполнилась,
+        // лишние цвета рисуем последним цветом палитры
+        Q_ASSERT_X(m_palette.size() < 256, "AlgorithmTrace", "palette overflow");
+        if (m_palette.size() < 256) {
+            m_palette.append(rgba);
+        }
+        index = int(m_palette.size()) - 1;
+    }
+
+    m_lastColor = index;
+    return quint8(index);
+}
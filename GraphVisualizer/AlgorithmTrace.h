@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <QColor>
+#include <QList>
+#include <vector>
+
+// Тип действия, которое нужно совершить в интерфейсе
+enum StepType {
+    HighlightNode, // Подсветить вершину
+    HighlightEdge, // Подсветить ребро
+    ResetColors    // Сбросить цвета (начало алгоритма)
+};
+
+// Структура одного шага анимации (распакованный вид)
+struct AlgorithmStep {
+    StepType type;
+    int index;     // Индекс вершины или ребра в GraphStore (-1 для ResetColors)
+    QColor color;  // В какой цвет красить
+};
+
+// Упакованный шаг: 8 байт вместо 24-32 у AlgorithmStep.
+// Цвет хранится номером в палитре трассы
+struct PackedStep {
+    quint8 type;     // StepType
+    quint8 color;    // индекс в палитре
+    quint16 reserved;
+    quint32 index;   // индекс элемента (NoIndex для ResetColors)
+};
+static_assert(sizeof(PackedStep) == 8, "PackedStep must stay 8 bytes");
+
+// Трасса алгоритма: шаги в упакованном виде, разложенные по блокам фиксированного размера.
+// Блоки не перевыделяются при росте, поэтому длинная трасса не копируется целиком,
+// как это делал QQueue при расширении. Палитра - не больше 256 цветов на трассу
+class AlgorithmTrace
+{
+public:
+    void append(const AlgorithmStep& step);
+    void append(const AlgorithmTrace& other); // дописать чужую трассу (палитры сливаются, шаги копируются блоками)
+
+    qsizetype size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // Распаковать шаг (без выделений памяти: цвет берется из палитры)
+    AlgorithmStep at(qsizetype i) const;
+
+    void clear();
+
+    // Сколько байт занимает трасса (блоки + палитра)
+    qsizetype memoryUsage() const;
+
+    // Упакованный вид как есть (для записи в файл): палитра и блоки шагов
+    const QList<QRgb>& palette() const { return m_palette; }
+    int chunkCount() const { return int(m_chunks.size()); }
+    const PackedStep* chunkData(int chunk) const { return m_chunks[chunk].data(); }
+    qsizetype chunkSize(int chunk) const { return qsizetype(m_chunks[chunk].size()); }
+
+    // Собрать трассу из упакованных шагов (например, прочитанных из файла).
+    // Индексы цветов за пределами палитры заменяются последним цветом
+    static AlgorithmTrace fromPacked(const PackedStep* steps, qsizetype count, const QRgb* palette, int paletteSize);
+
+private:
+    static constexpr int ChunkShift = 16;                 // 65536 шагов = 512 КБ на блок
+    static constexpr qsizetype ChunkSize = qsizetype(1) << ChunkShift;
+    static constexpr quint32 NoIndex = 0xFFFFFFFFu;
+
+    std::vector<PackedStep>& writableChunk(); // последний блок, если в нем есть место, иначе новый
+    quint8 paletteIndex(QRgb rgba);
+
+    std::vector<std::vector<PackedStep>> m_chunks;
+    qsizetype m_size = 0;
+
+    QList<QRgb> m_palette;
+    int m_lastColor = -1; // шаги подряд обычно одного цвета - проверяем его первым
+};
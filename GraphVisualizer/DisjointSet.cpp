@@ -0,0 +1,43 @@
+﻿#include "DisjointSet.h"
+
+#include <numeric>
+
+DisjointSet::DisjointSet(int count)
+{
+    reset(count);
+}
+
+void DisjointSet::reset(int count)
+{
+    // Изначально каждый элемент - сам себе начальник
+    m_parent.resize(count);
+    std::iota(m_parent.begin(), m_parent.end(), 0);
+    m_rank.assign(count, 0);
+}
+
+int DisjointSet::find(int x)
+{
+    // Каждый пройденный узел перевешиваем на "деда" - без рекурсии и без второго прохода
+    while (m_parent[x] != x) {
+        m_parent[x] = m_parent[m_parent[x]];
+        x = m_parent[x];
+    }
+    return x;
+}
+
+bool DisjointSet::unite(int a, int b)
+{
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+
+    // Меньшее дерево подвешиваем к большему
+    if (m_rank[a] < m_rank[b]) {
+        m_parent[a] = b;
+    }
+    else {
+        m_parent[b] = a;
+        if (m_rank[a] == m_rank[b]) m_rank[a]++;
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include <vector>
+
+// Система непересекающихся множеств (DSU) над индексами [0, count).
+// Родители и ранги - плоские массивы, поиск корня итеративный
+// с сокращением пути вдвое (path halving), объединение по рангу.
+class DisjointSet
+{
+public:
+    explicit DisjointSet(int count = 0);
+
+    void reset(int count);
+
+    // Найти представителя множества
+    int find(int x);
+
+    // Объединить множества; false, если они уже совпадали
+    bool unite(int a, int b);
+
+private:
+    std::vector<int> m_parent;
+    std::vector<unsigned char> m_rank; // ранг не превышает log2(count)
+};
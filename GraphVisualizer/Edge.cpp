@@ -1,30 +1,134 @@
 ﻿#include "Edge.h"
 #include "VertexItem.h"
+#include "EdgeLayer.h"
 
 #include <QPen>
 #include <QInputDialog>
 #include <QtMath>
+#include <QStyleOptionGraphicsItem>
+#include <QCoreApplication>
+
+#include "LevelOfDetail.h"
 
 Edge::Edge(VertexItem* source, VertexItem* dest) 
 	: source(source), dest(dest), m_weight(1)
 {
 	setZValue(-1);		//чтобы ребра были ЗА вершинами, а не перекрывали их
 	m_color = Qt::black;
+	m_pen = QPen(m_color, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+	m_thinPen = QPen(m_color, 0);
 	adjust();
 }
 
+Edge::~Edge()
+{
+	// Ребро удаляют, пока оно ждет adjust() - вычеркиваем (бывает редко, removeOne хватает)
+	if (m_adjustScheduled) s_scheduled.removeOne(this);
+	detachFromLayer();
+}
+
+QList<Edge*> Edge::s_scheduled;
+
+void Edge::scheduleAdjust()
+{
+	if (m_adjustScheduled) return; // уже в очереди - второй конец или второй сдвиг за кадр
+	m_adjustScheduled = true;
+
+	// Первое ребро в пустой очереди заказывает ее разбор. Вызов ставится в очередь
+	// событий раньше, чем сцена закажет обработку грязных элементов, поэтому
+	// кадр рисуется уже с новой геометрией ребер
+	if (s_scheduled.isEmpty()) {
+		QMetaObject::invokeMethod(QCoreApplication::instance(), &Edge::flushScheduledAdjusts, Qt::QueuedConnection);
+	}
+	s_scheduled.append(this);
+}
+
+void Edge::flushScheduledAdjusts()
+{
+	// adjust() не ставит ребер в очередь, так что список не меняется по ходу обхода
+	const QList<Edge*> edges = std::move(s_scheduled);
+	s_scheduled.clear();
+
+	for (Edge* edge : edges) {
+		edge->m_adjustScheduled = false;
+		edge->adjust();
+	}
+}
+
 void Edge::setColor(QColor color)
 {
+	if (m_color == color) return; // не просим лишнюю перерисовку
 	m_color = color;
-	update();
+	m_pen.setColor(color);
+	m_thinPen.setColor(color);
+
+	if (m_layer) m_layer->setColor(m_layerSlot, color);
+	else update();
+}
+
+void Edge::attachToLayer(EdgeLayer* layer)
+{
+	detachFromLayer();
+
+	m_layer = layer;
+	m_layerSlot = layer->addEdge(sourcePoint, destPoint, m_color);
+}
+
+void Edge::attachToLayer(EdgeLayer* layer, int slot)
+{
+	detachFromLayer();
+
+	m_layer = layer;
+	m_layerSlot = slot;
+}
+
+void Edge::detachFromLayer()
+{
+	if (!m_layer) return;
+
+	m_layer->removeEdge(m_layerSlot);
+	m_layer = nullptr;
+	m_layerSlot = -1;
 }
 
 void Edge::setWeight(int w)
 {
 	m_weight = w;
+	m_labelValid = false; // подпись пересоберется при следующей отрисовке
 	update(); // Команда перерисовать линию (чтобы цифра обновилась)
 }
 
+// Фон под подписью веса (полупрозрачный белый)
+static const QColor LabelBackground(255, 255, 255, 200);
+
+void Edge::updateLabel(const QFont& baseFont)
+{
+	m_baseFont = baseFont;
+	m_labelFont = baseFont;
+	m_labelFont.setBold(true);
+
+	// Разметку текста считаем один раз; меряем тем же жирным шрифтом, которым рисуем
+	m_label.setText(QString::number(m_weight));
+	m_label.setPerformanceHint(QStaticText::AggressiveCaching);
+	m_label.prepare(QTransform(), m_labelFont);
+	m_labelSize = m_label.size();
+	m_labelValid = true;
+
+	updateLabelRect();
+}
+
+void Edge::updateLabelRect()
+{
+	QPointF center = (sourcePoint + destPoint) / 2.0;
+
+	// Прямоугольник точно под размер текста + небольшой отступ (padding)
+	// Сдвигаем на половину ширины/высоты, чтобы центр текста совпал с центром линии
+	m_labelRect = QRectF(center.x() - m_labelSize.width() / 2.0 - 4,
+		center.y() - m_labelSize.height() / 2.0,
+		m_labelSize.width() + 8, // ширина + отступы
+		m_labelSize.height());   // высота
+}
+
 void Edge::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
 {
 	bool ok;
@@ -55,6 +159,11 @@ void Edge::adjust()
 	
 	sourcePoint = source->pos();
 	destPoint = dest->pos();
+
+	if (m_layer) m_layer->setLine(m_layerSlot, sourcePoint, destPoint);
+
+	// Размер подписи не изменился - сдвигаем только ее плашку
+	if (m_labelValid) updateLabelRect();
 }
 
 QRectF Edge::boundingRect() const
@@ -85,28 +194,28 @@ void Edge::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
 
 	if (qFuzzyCompare(line.length(), qreal(0.))) return;
 
-	painter->setPen(QPen(m_color, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+	// На мелком масштабе: тонкая линия без сглаживания и без подписи
+	const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+
+	if (detail < ShapeDetail) {
+		painter->setRenderHint(QPainter::Antialiasing, false);
+		painter->setPen(m_thinPen);
+		painter->drawLine(line);
+		return;
+	}
+
+	painter->setPen(m_pen);
 	painter->drawLine(line);
 
-	QPointF center = (sourcePoint + destPoint) / 2.0;
-	QString text = QString::number(m_weight);
+	if (detail < LabelDetail) return; // цифру веса уже не прочитать
 
-	// --- ИСПРАВЛЕНИЕ: Вычисляем размер текста динамически ---
-	QFontMetrics fm(painter->font());
-	int textWidth = fm.horizontalAdvance(text);
-	int textHeight = fm.height();
+	// Подпись пересобираем, только если сменился вес или шрифт сцены
+	if (!m_labelValid || painter->font() != m_baseFont) {
+		updateLabel(painter->font());
+	}
 
-	// Создаем прямоугольник точно под размер текста + небольшой отступ (padding)
-	// Сдвигаем на половину ширины/высоты, чтобы центр текста совпал с центром линии
-	QRectF textRect(center.x() - textWidth / 2.0 - 4,
-		center.y() - textHeight / 2.0,
-		textWidth + 8, // ширина + отступы
-		textHeight);   // высота
-
-	painter->fillRect(textRect, QColor(255, 255, 255, 200));
-	QFont font = painter->font();
-	font.setBold(true);
-	painter->setFont(font);
+	painter->fillRect(m_labelRect, LabelBackground);
+	painter->setFont(m_labelFont);
 	painter->setPen(Qt::blue);
-	painter->drawText(textRect, Qt::AlignCenter, text);
+	painter->drawStaticText(QPointF(m_labelRect.x() + 4, m_labelRect.y()), m_label);
 }
\ No newline at end of file
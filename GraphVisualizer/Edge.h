@@ -3,18 +3,28 @@
 #include <QGraphicsItem>
 #include <QPainter>
 #include <QGraphicsSceneMouseEvent>
+#include <QStaticText>
+#include <QPen>
 
 #include "VertexItem.h"
 
-class VertexItem;		// ,     (   include)
+class VertexItem;		//сообщаем компилятору, что такой класс есть (чтобы избежать циклического include)
+class EdgeLayer;
 
 class Edge : public QGraphicsItem
 {
 public:
 	Edge(VertexItem* source, VertexItem* dest);
+	~Edge() override;
 
 	void adjust();
 
+	// Отложенный adjust(): ребро встает в очередь один раз, сколько бы раз ни сдвинулись
+	// его концы, и очередь разбирается в ближайшем проходе цикла событий - до того,
+	// как сцена соберет кадр. Так при перетаскивании ребро пересчитывается раз в кадр
+	void scheduleAdjust();
+	static void flushScheduledAdjusts();	//разобрать очередь сейчас
+
 	VertexItem* sourceNode() const{ return source; }
 	VertexItem* destNode() const{ return dest; }
 
@@ -22,6 +32,14 @@ public:
 	int getWeight() const { return m_weight; }
 
 	void setColor(QColor color);
+	QColor getColor() const { return m_color; }
+
+	// Режим слоя ребер: ребро убрано из сцены, его рисует EdgeLayer,
+	// а adjust() и setColor() обновляют ячейку ребра в слое
+	void attachToLayer(EdgeLayer* layer);
+	void attachToLayer(EdgeLayer* layer, int slot);	//ячейка уже заполнена пачкой (EdgeLayer::addEdges)
+	void detachFromLayer();
+	bool inLayer() const { return m_layer != nullptr; }
 
 	QRectF boundingRect() const override;
 
@@ -41,5 +59,26 @@ private:
 	int m_weight;
 
 	QColor m_color;
+
+	// Кэш отрисовки: перо и подпись веса не пересобираются на каждый paint.
+	// Перо меняется в setColor, подпись - в setWeight (и при смене шрифта сцены),
+	// положение подписи - в adjust
+	QPen m_pen;
+	QPen m_thinPen;			//косметическое перо для мелкого масштаба
+	QStaticText m_label;	//текст веса, разметка готова заранее
+	QFont m_labelFont;		//жирный шрифт подписи
+	QFont m_baseFont;		//шрифт, от которого он построен
+	QSizeF m_labelSize;
+	QRectF m_labelRect;		//плашка под подписью (в координатах сцены)
+	bool m_labelValid = false;
+
+	void updateLabel(const QFont& baseFont);
+	void updateLabelRect();
+
+	EdgeLayer* m_layer = nullptr;
+	int m_layerSlot = -1;
+
+	bool m_adjustScheduled = false;
+	static QList<Edge*> s_scheduled;	//ребра, ждущие adjust()
 };
 
@@ -0,0 +1,177 @@
+﻿#include "EdgeLayer.h"
+#include "LevelOfDetail.h"
+
+#include <QStyleOptionGraphicsItem>
+
+// Запас вокруг линии под толщину пера (как у Edge)
+static const qreal PenMargin = 1;
+
+EdgeLayer::EdgeLayer()
+{
+	setZValue(-1);		//ребра ЗА вершинами, как и отдельные Edge
+	setFlag(ItemUsesExtendedStyleOption);	//нужен точный exposedRect для отсечения
+	setAcceptedMouseButtons(Qt::NoButton);
+}
+
+int EdgeLayer::addEdge(const QPointF& p1, const QPointF& p2, const QColor& color)
+{
+	const QLineF line(p1, p2);
+	growBounds(lineRect(line));
+
+	int slot;
+	if (!m_free.empty()) {
+		slot = m_free.back();
+		m_free.pop_back();
+		m_lines[slot] = line;
+		m_colors[slot] = paletteIndex(color);
+		m_alive[slot] = 1;
+	}
+	else {
+		slot = int(m_lines.size());
+		m_lines.push_back(line);
+		m_colors.push_back(paletteIndex(color));
+		m_alive.push_back(1);
+	}
+
+	update(lineRect(line));
+	return slot;
+}
+
+int EdgeLayer::addEdges(const QLineF* lines, int count, const QColor& color)
+{
+	const int first = int(m_lines.size());
+	if (count <= 0) return first;
+
+	// Свободные ячейки не занимаем: номера пачки должны идти подряд
+	const quint8 index = paletteIndex(color);
+	m_lines.insert(m_lines.end(), lines, lines + count);
+	m_colors.resize(m_lines.size(), index);
+	m_alive.resize(m_lines.size(), 1);
+
+	qreal left = lines[0].x1(), right = left;
+	qreal top = lines[0].y1(), bottom = top;
+	for (int i = 0; i < count; ++i) {
+		const QLineF& line = lines[i];
+		left = qMin(left, qMin(line.x1(), line.x2()));
+		right = qMax(right, qMax(line.x1(), line.x2()));
+		top = qMin(top, qMin(line.y1(), line.y2()));
+		bottom = qMax(bottom, qMax(line.y1(), line.y2()));
+	}
+
+	const QRectF rect = QRectF(QPointF(left, top), QPointF(right, bottom)).adjusted(-PenMargin, -PenMargin, PenMargin, PenMargin);
+	growBounds(rect);
+	update(rect);
+	return first;
+}
+
+void EdgeLayer::removeEdge(int slot)
+{
+	if (slot < 0 || slot >= int(m_lines.size()) || !m_alive[slot]) return;
+
+	update(lineRect(m_lines[slot]));
+	m_alive[slot] = 0;
+	m_free.push_back(slot);
+}
+
+void EdgeLayer::setLine(int slot, const QPointF& p1, const QPointF& p2)
+{
+	if (slot < 0 || slot >= int(m_lines.size())) return;
+
+	const QLineF line(p1, p2);
+
+	// Перерисовать старое место и новое
+	update(lineRect(m_lines[slot]));
+	growBounds(lineRect(line));
+	m_lines[slot] = line;
+	update(lineRect(line));
+}
+
+void EdgeLayer::setColor(int slot, const QColor& color)
+{
+	if (slot < 0 || slot >= int(m_lines.size())) return;
+
+	const quint8 index = paletteIndex(color);
+	if (m_colors[slot] == index) return;
+
+	m_colors[slot] = index;
+	update(lineRect(m_lines[slot]));
+}
+
+QRectF EdgeLayer::boundingRect() const
+{
+	return m_bounds;
+}
+
+QPainterPath EdgeLayer::shape() const
+{
+	// Клики проходят сквозь слой: редактирование ребер мышкой в этом режиме недоступно
+	return QPainterPath();
+}
+
+void EdgeLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+	Q_UNUSED(widget);
+
+	const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+	const bool thin = detail < ShapeDetail;
+	if (thin) painter->setRenderHint(QPainter::Antialiasing, false);
+
+	// 1. Отсекаем по видимой области и раскладываем линии по цветам
+	const QRectF exposed = option->exposedRect.adjusted(-PenMargin, -PenMargin, PenMargin, PenMargin);
+	const qreal left = exposed.left(), right = exposed.right();
+	const qreal top = exposed.top(), bottom = exposed.bottom();
+
+	m_buckets.resize(m_palette.size());
+	for (std::vector<QLineF>& bucket : m_buckets) {
+		bucket.clear();
+	}
+
+	for (size_t i = 0; i < m_lines.size(); ++i) {
+		if (!m_alive[i]) continue;
+
+		const QLineF& line = m_lines[i];
+		if (qMax(line.x1(), line.x2()) < left || qMin(line.x1(), line.x2()) > right) continue;
+		if (qMax(line.y1(), line.y2()) < top || qMin(line.y1(), line.y2()) > bottom) continue;
+
+		m_buckets[m_colors[i]].push_back(line);
+	}
+
+	// 2. Один вызов drawLines на цвет
+	for (size_t c = 0; c < m_buckets.size(); ++c) {
+		const std::vector<QLineF>& bucket = m_buckets[c];
+		if (bucket.empty()) continue;
+
+		painter->setPen(thin ? m_thinPens[c] : m_pens[c]);
+		painter->drawLines(bucket.data(), int(bucket.size()));
+	}
+}
+
+quint8 EdgeLayer::paletteIndex(const QColor& color)
+{
+	const QRgb rgba = color.rgba();
+
+	int index = int(m_palette.indexOf(rgba));
+	if (index < 0) {
+		// Алгоритмы используют единицы цветов; при переполнении рисуем последним цветом
+		if (m_palette.size() < 256) {
+			m_palette.append(rgba);
+			m_pens.push_back(QPen(color, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+			m_thinPens.push_back(QPen(color, 0));
+		}
+		index = int(m_palette.size()) - 1;
+	}
+	return quint8(index);
+}
+
+void EdgeLayer::growBounds(const QRectF& rect)
+{
+	if (m_bounds.contains(rect)) return;
+
+	prepareGeometryChange();
+	m_bounds = m_bounds.isNull() ? rect : m_bounds.united(rect);
+}
+
+QRectF EdgeLayer::lineRect(const QLineF& line)
+{
+	return QRectF(line.p1(), line.p2()).normalized().adjusted(-PenMargin, -PenMargin, PenMargin, PenMargin);
+}
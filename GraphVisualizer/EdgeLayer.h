@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPen>
+#include <QList>
+#include <vector>
+
+// Слой ребер: один элемент сцены вместо тысяч Edge.
+// Геометрия и цвета всех ребер лежат в плоских массивах, отсечение по видимой
+// области делает сам слой, рисует пачками drawLines - по одной на цвет.
+// Объекты Edge в этом режиме остаются (как данные), но в сцену не добавляются:
+// их adjust() и setColor() пересылают изменения в свою ячейку слоя
+class EdgeLayer : public QGraphicsItem
+{
+public:
+	EdgeLayer();
+
+	// Ячейки переиспользуются после удаления, номер ячейки стабилен
+	int addEdge(const QPointF& p1, const QPointF& p2, const QColor& color);
+	// Пачка ребер одного цвета (открытие файла): count ячеек подряд, вернет номер первой.
+	// Границы и перерисовка - один раз на пачку, а не на каждую линию
+	int addEdges(const QLineF* lines, int count, const QColor& color);
+	void removeEdge(int slot);
+
+	void setLine(int slot, const QPointF& p1, const QPointF& p2);
+	void setColor(int slot, const QColor& color);
+
+	int edgeCount() const { return int(m_lines.size() - m_free.size()); }
+
+	QRectF boundingRect() const override;
+	QPainterPath shape() const override;	//пустая: слой не ловит клики
+	void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+	quint8 paletteIndex(const QColor& color);
+	void growBounds(const QRectF& rect);
+	static QRectF lineRect(const QLineF& line);
+
+	std::vector<QLineF> m_lines;
+	std::vector<quint8> m_colors;	//индекс цвета в палитре
+	std::vector<char> m_alive;
+	std::vector<int> m_free;		//освободившиеся ячейки
+
+	// Палитра ребер и готовые перья для каждого цвета (толстое и косметическое)
+	QList<QRgb> m_palette;
+	std::vector<QPen> m_pens;
+	std::vector<QPen> m_thinPens;
+
+	// Границы слоя только растут: сужать их при каждом сдвиге вершины - лишний O(E)
+	QRectF m_bounds;
+
+	// Видимые линии, разложенные по цветам (буферы переживают кадр, чтобы не выделять память)
+	std::vector<std::vector<QLineF>> m_buckets;
+};
@@ -0,0 +1,262 @@
+﻿#include "ForceLayout.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Вершин на задачу пула: меньше - накладные расходы, больше - хуже делится между потоками
+const int BlockSize = 1024;
+// Глубже дерево не делим: совпадающие точки остаются в одном листе
+const int MaxTreeDepth = 24;
+// Стек обхода: на каждом уровне откладываем до 4 детей
+const int TraversalStackSize = 4 * MaxTreeDepth + 8;
+// Ближе этого вершины считаются совпадающими - расталкиваем их в условную сторону
+const float MinDistanceSquared = 1e-4f;
+
+}
+
+void ForceLayout::setGraph(const GraphSpan& graph)
+{
+    const int n = graph.vertexCount();
+    m_x.resize(n);
+    m_y.resize(n);
+    m_dx.assign(n, 0);
+    m_dy.assign(n, 0);
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < n; ++i) {
+        m_x[i] = graph.vertices[i].x;
+        m_y[i] = graph.vertices[i].y;
+        minX = i ? qMin(minX, m_x[i]) : m_x[i];
+        maxX = i ? qMax(maxX, m_x[i]) : m_x[i];
+        minY = i ? qMin(minY, m_y[i]) : m_y[i];
+        maxY = i ? qMax(maxY, m_y[i]) : m_y[i];
+    }
+
+    // Все в одной точке - силам не из чего выбрать направление: раздвигаем по кругу
+    const float k = m_settings.idealDistance;
+    if (n > 1 && maxX - minX < 1e-3f && maxY - minY < 1e-3f) {
+        const float radius = k * std::sqrt(float(n)) / 2;
+        for (int i = 0; i < n; ++i) {
+            const float angle = float(2 * M_PI) * i / n;
+            m_x[i] = minX + radius * std::cos(angle);
+            m_y[i] = minY + radius * std::sin(angle);
+        }
+        maxX = minX + radius;
+        maxY = minY + radius;
+    }
+
+    // Смежность без петель и битых ребер
+    m_adjOffsets.assign(n + 1, 0);
+    for (int e = 0; e < graph.edgeCount(); ++e) {
+        const int u = graph.edges[e].source;
+        const int v = graph.edges[e].target;
+        if (u < 0 || v < 0 || u >= n || v >= n || u == v) continue;
+        m_adjOffsets[u + 1]++;
+        m_adjOffsets[v + 1]++;
+    }
+    for (int i = 0; i < n; ++i) {
+        m_adjOffsets[i + 1] += m_adjOffsets[i];
+    }
+
+    m_adjVertex.resize(m_adjOffsets[n]);
+    std::vector<int> cursor(m_adjOffsets.begin(), m_adjOffsets.end() - 1);
+    for (int e = 0; e < graph.edgeCount(); ++e) {
+        const int u = graph.edges[e].source;
+        const int v = graph.edges[e].target;
+        if (u < 0 || v < 0 || u >= n || v >= n || u == v) continue;
+        m_adjVertex[cursor[u]++] = v;
+        m_adjVertex[cursor[v]++] = u;
+    }
+
+    m_blocks.clear();
+    for (int begin = 0; begin < n; begin += BlockSize) {
+        m_blocks.append({ begin, qMin(n, begin + BlockSize) });
+    }
+
+    // Стартовая температура - порядка размера готовой картинки (k * sqrt(n)):
+    // вершины успевают перебраться через весь граф и распутаться
+    m_iteration = 0;
+    m_temperature = qMax(k * std::sqrt(float(n)), 0.1f * qMax(maxX - minX, maxY - minY));
+}
+
+bool ForceLayout::isFinished() const
+{
+    return m_x.empty()
+        || m_iteration >= m_settings.maxIterations
+        || m_temperature < m_settings.minTemperature;
+}
+
+bool ForceLayout::step()
+{
+    if (isFinished()) return false;
+
+    // 1. Квадродерево по текущим координатам (последовательно - это малая часть времени)
+    buildTree();
+
+    // 2. Силы: каждая вершина считает свою сумму сама, без общих записей
+    QtConcurrent::blockingMap(m_blocks, [this](const Block& block) { accumulateForces(block); });
+
+    // 3. Сдвиг не длиннее температуры. Плоский цикл по массивам - векторизуется
+    const int n = vertexCount();
+    const float t = m_temperature;
+    float* x = m_x.data();
+    float* y = m_y.data();
+    const float* dx = m_dx.data();
+    const float* dy = m_dy.data();
+    for (int i = 0; i < n; ++i) {
+        const float length = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]) + 1e-9f;
+        const float scale = std::min(length, t) / length;
+        x[i] += dx[i] * scale;
+        y[i] += dy[i] * scale;
+    }
+
+    m_temperature *= m_settings.cooling;
+    m_iteration++;
+    return true;
+}
+
+void ForceLayout::buildTree()
+{
+    const int n = vertexCount();
+
+    // Корень - квадрат, покрывающий все вершины
+    const auto [minX, maxX] = std::minmax_element(m_x.begin(), m_x.end());
+    const auto [minY, maxY] = std::minmax_element(m_y.begin(), m_y.end());
+    const float half = qMax(*maxX - *minX, *maxY - *minY) / 2 + 1;
+
+    m_tree.clear();
+    m_tree.reserve(size_t(n) * 2);
+    m_tree.push_back({ (*minX + *maxX) / 2, (*minY + *maxY) / 2, half, 0, 0, 0, -1, -1 });
+
+    for (int v = 0; v < n; ++v) {
+        insert(v);
+    }
+}
+
+void ForceLayout::insert(int v)
+{
+    const float x = m_x[v];
+    const float y = m_y[v];
+
+    int node = 0;
+    for (int depth = 0; ; ++depth) {
+        QuadNode& n = m_tree[node];
+        n.mass++;
+        n.sumX += x;
+        n.sumY += y;
+
+        // Внутренний узел - спускаемся в нужную четверть
+        if (n.child >= 0) {
+            node = n.child + (x >= n.centerX ? 1 : 0) + (y >= n.centerY ? 2 : 0);
+            continue;
+        }
+
+        // Пустой лист - вершина ложится сюда
+        if (n.body < 0) {
+            n.body = v;
+            return;
+        }
+
+        // Совпадающие точки: дальше не делим, лист просто тяжелеет
+        if (depth >= MaxTreeDepth) return;
+
+        // Занятый лист делим на четыре и спускаем туда прежнюю вершину
+        const int old = n.body;
+        const float cx = n.centerX, cy = n.centerY, quarter = n.half / 2;
+        const int firstChild = int(m_tree.size());
+        n.body = -1;
+        n.child = firstChild;
+
+        // n больше не трогаем: push_back может переложить m_tree
+        for (int q = 0; q < 4; ++q) {
+            m_tree.push_back({ cx + ((q & 1) ? quarter : -quarter), cy + ((q & 2) ? quarter : -quarter),
+                quarter, 0, 0, 0, -1, -1 });
+        }
+
+        QuadNode& oldLeaf = m_tree[firstChild + (m_x[old] >= cx ? 1 : 0) + (m_y[old] >= cy ? 2 : 0)];
+        oldLeaf.mass = 1;
+        oldLeaf.sumX = m_x[old];
+        oldLeaf.sumY = m_y[old];
+        oldLeaf.body = old;
+
+        node = firstChild + (x >= cx ? 1 : 0) + (y >= cy ? 2 : 0);
+    }
+}
+
+void ForceLayout::accumulateForces(const Block& block)
+{
+    const float k = m_settings.idealDistance;
+    const float k2 = k * k;
+    const float theta2 = m_settings.theta * m_settings.theta;
+    const float gravity = m_settings.gravity;
+
+    const QuadNode& root = m_tree[0];
+    const float centerX = root.sumX / root.mass;
+    const float centerY = root.sumY / root.mass;
+
+    int stack[TraversalStackSize];
+
+    for (int v = block.begin; v < block.end; ++v) {
+        const float x = m_x[v];
+        const float y = m_y[v];
+        float fx = 0, fy = 0;
+
+        // Отталкивание: далекий квадрат (сторона / расстояние < theta) - одна тяжелая точка
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const QuadNode& n = m_tree[stack[--top]];
+            if (n.mass == 0) continue;
+
+            const float comX = n.sumX / n.mass;
+            const float comY = n.sumY / n.mass;
+            float dx = x - comX;
+            float dy = y - comY;
+            float d2 = dx * dx + dy * dy;
+
+            const bool leaf = n.child < 0;
+            if (!leaf && 4 * n.half * n.half >= theta2 * d2) {
+                for (int q = 0; q < 4; ++q) stack[top++] = n.child + q;
+                continue;
+            }
+
+            // В своем листе вершина отталкивается только от совпавших с ней
+            const int mass = (leaf && n.body == v) ? n.mass - 1 : n.mass;
+            if (mass == 0) continue;
+
+            if (d2 < MinDistanceSquared) {
+                // Совпали - толкаем в сторону, зависящую от номера (детерминированно)
+                const float angle = float(v) * 2.39996f;
+                dx = std::cos(angle) * 0.01f;
+                dy = std::sin(angle) * 0.01f;
+                d2 = MinDistanceSquared;
+            }
+
+            // |F| = k^2 / d, направление dx / d  =>  F = k^2 * dx / d^2
+            const float f = mass * k2 / d2;
+            fx += dx * f;
+            fy += dy * f;
+        }
+
+        // Притяжение соседей: |F| = d^2 / k  =>  F = dx * d / k
+        for (int a = m_adjOffsets[v]; a < m_adjOffsets[v + 1]; ++a) {
+            const int u = m_adjVertex[a];
+            const float dx = m_x[u] - x;
+            const float dy = m_y[u] - y;
+            const float d = std::sqrt(dx * dx + dy * dy);
+            fx += dx * d / k;
+            fy += dy * d / k;
+        }
+
+        // Гравитация к центру масс
+        fx += gravity * (centerX - x);
+        fy += gravity * (centerY - y);
+
+        m_dx[v] = fx;
+        m_dy[v] = fy;
+    }
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <QList>
+#include <vector>
+
+#include "GraphStore.h"
+
+// Силовая раскладка Фрюхтермана - Рейнгольда:
+//   отталкивание всех пар k^2/d - через квадродерево Барнса - Хата за O(n log n),
+//   притяжение по ребрам d^2/k, слабая гравитация к центру (чтобы компоненты не разлетались),
+//   сдвиг за итерацию ограничен "температурой", которая остывает.
+// Координаты хранятся отдельными массивами x и y (SoA): силы считаются параллельно
+// по блокам вершин (QtConcurrent), а сдвиг - простым циклом, который векторизует компилятор.
+// Сцену не трогает - годится для рабочего потока
+class ForceLayout
+{
+public:
+    struct Settings {
+        float idealDistance = 30;    // k из FR: масштаб картинки (ребра выходят в несколько k)
+        float theta = 0.9f;          // точность Барнса - Хата (0 - точный расчет, больше - грубее)
+        float gravity = 0.02f;       // притяжение к центру масс
+        float cooling = 0.99f;       // множитель температуры за итерацию (медленнее - меньше пересечений)
+        float minTemperature = 0.5f; // остановка, когда сдвиг ограничен этим (в пикселях)
+        int maxIterations = 1000;
+    };
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& settings() const { return m_settings; }
+
+    // Начать раскладку с текущих координат графа (граф копируется, живет отдельно)
+    void setGraph(const GraphSpan& graph);
+
+    // Одна итерация. false - раскладка уже остыла (или граф пуст)
+    bool step();
+    bool isFinished() const;
+
+    int iteration() const { return m_iteration; }
+    float temperature() const { return m_temperature; }
+
+    int vertexCount() const { return int(m_x.size()); }
+    const std::vector<float>& xs() const { return m_x; }
+    const std::vector<float>& ys() const { return m_y; }
+
+private:
+    // Узел квадродерева. Масса - число вершин под узлом, центр масс - среднее их координат
+    struct QuadNode {
+        float centerX, centerY;      // центр квадрата
+        float half;                  // половина стороны
+        float sumX, sumY;            // сумма координат вершин под узлом
+        int mass;
+        int child;                   // первый из четырех детей, -1 - лист
+        int body;                    // лист: первая вершина в нем, -1 - пустой
+    };
+
+    // Блок вершин для одной задачи пула
+    struct Block {
+        int begin;
+        int end;
+    };
+
+    void buildTree();
+    void insert(int v);
+    void accumulateForces(const Block& block);
+
+    Settings m_settings;
+
+    std::vector<float> m_x, m_y;     // координаты
+    std::vector<float> m_dx, m_dy;   // сила на вершину в текущей итерации
+
+    // Смежность (CSR), как в решателе: соседи i - [m_adjOffsets[i], m_adjOffsets[i + 1])
+    std::vector<int> m_adjOffsets;
+    std::vector<int> m_adjVertex;
+
+    std::vector<QuadNode> m_tree;
+    QList<Block> m_blocks;
+
+    int m_iteration = 0;
+    float m_temperature = 0;
+};
@@ -0,0 +1,271 @@
+﻿#include "GraphFile.h"
+
+#include <QSaveFile>
+#include <cstring>
+#include <limits>
+
+// Формат пишется и читается как есть (memcpy/отображение), поэтому
+// раскладка записей в памяти обязана совпадать с файловой
+static_assert(sizeof(GraphVertex) == 12, "GraphVertex layout must match the file format");
+static_assert(sizeof(GraphEdge) == 12, "GraphEdge layout must match the file format");
+static_assert(sizeof(PackedStep) == 8, "PackedStep layout must match the file format");
+
+namespace {
+
+const char Magic[4] = { 'G', 'V', 'G', 'F' };
+
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 headerSize;
+    quint32 traceCount;
+    quint64 vertexCount;
+    quint64 edgeCount;
+    quint64 vertexOffset;
+    quint64 edgeOffset;
+    quint64 traceOffset;   // оглавление трасс (0 - трасс нет)
+};
+static_assert(sizeof(FileHeader) == 56, "FileHeader must stay 56 bytes");
+
+struct TraceHeader {
+    char name[32];         // UTF-8, дополнено нулями
+    quint32 paletteSize;
+    quint32 reserved;
+    quint64 stepCount;
+    quint64 paletteOffset;
+    quint64 stepsOffset;
+};
+static_assert(sizeof(TraceHeader) == 64, "TraceHeader must stay 64 bytes");
+
+quint64 alignUp(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+// Дописать нули от конца блока длиной bytes до границы 8 байт
+bool writePadding(QSaveFile& file, quint64 bytes)
+{
+    static const char zeros[8] = {};
+    const quint64 padding = alignUp(bytes) - bytes;
+    return padding == 0 || file.write(zeros, qint64(padding)) == qint64(padding);
+}
+
+// Записать блок и дополнить нулями до границы 8 байт
+bool writeBlock(QSaveFile& file, const void* data, quint64 bytes)
+{
+    if (bytes > 0 && file.write(static_cast<const char*>(data), qint64(bytes)) != qint64(bytes)) {
+        return false;
+    }
+    return writePadding(file, bytes);
+}
+
+// Блок [offset, offset + count * itemSize) целиком внутри файла (без переполнения)
+bool blockFits(quint64 offset, quint64 count, quint64 itemSize, quint64 fileSize)
+{
+    if (offset % 4 != 0 || offset > fileSize) return false;
+    return count <= (fileSize - offset) / itemSize;
+}
+
+}
+
+bool GraphFile::save(const QString& path, const GraphSpan& graph, const QList<Trace>& traces,
+    QString* errorString)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    if (errorString) *errorString = "Сохранение поддерживается только на little-endian платформах";
+    return false;
+#endif
+
+    // 1. Раскладка: заголовок, вершины, ребра, оглавление трасс, данные трасс
+    FileHeader header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(FileHeader);
+    header.traceCount = quint32(traces.size());
+    header.vertexCount = quint64(graph.vertexCount());
+    header.edgeCount = quint64(graph.edgeCount());
+    header.vertexOffset = alignUp(sizeof(FileHeader));
+    header.edgeOffset = header.vertexOffset + alignUp(header.vertexCount * sizeof(GraphVertex));
+
+    quint64 offset = header.edgeOffset + alignUp(header.edgeCount * sizeof(GraphEdge));
+    header.traceOffset = traces.isEmpty() ? 0 : offset;
+    offset += traces.size() * sizeof(TraceHeader);
+
+    std::vector<TraceHeader> traceHeaders(traces.size());
+    for (int i = 0; i < traces.size(); ++i) {
+        const Trace& trace = traces[i];
+        TraceHeader& th = traceHeaders[i];
+
+        const QByteArray name = trace.name.toUtf8().left(int(sizeof(th.name)) - 1);
+        std::memcpy(th.name, name.constData(), size_t(name.size()));
+        th.paletteSize = quint32(trace.steps.palette().size());
+        th.stepCount = quint64(trace.steps.size());
+        th.paletteOffset = offset;
+        offset += alignUp(th.paletteSize * sizeof(QRgb));
+        th.stepsOffset = offset;
+        offset += alignUp(th.stepCount * sizeof(PackedStep));
+    }
+
+    // 2. Запись (атомарно: файл заменяется только после успешного commit)
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+
+    bool ok = writeBlock(file, &header, sizeof(header))
+        && writeBlock(file, graph.vertices, header.vertexCount * sizeof(GraphVertex))
+        && writeBlock(file, graph.edges, header.edgeCount * sizeof(GraphEdge));
+
+    if (ok && !traceHeaders.empty()) {
+        ok = file.write(reinterpret_cast<const char*>(traceHeaders.data()),
+            qint64(traceHeaders.size() * sizeof(TraceHeader))) == qint64(traceHeaders.size() * sizeof(TraceHeader));
+    }
+
+    for (int i = 0; ok && i < traces.size(); ++i) {
+        const AlgorithmTrace& steps = traces[i].steps;
+        ok = writeBlock(file, steps.palette().constData(), quint64(steps.palette().size()) * sizeof(QRgb));
+
+        // Шаги пишем блоками трассы подряд, выравниваем только конец
+        quint64 written = 0;
+        for (int c = 0; ok && c < steps.chunkCount(); ++c) {
+            const qint64 bytes = qint64(steps.chunkSize(c) * sizeof(PackedStep));
+            ok = file.write(reinterpret_cast<const char*>(steps.chunkData(c)), bytes) == bytes;
+            written += quint64(bytes);
+        }
+        if (ok) ok = writePadding(file, written);
+    }
+
+    if (!ok || !file.commit()) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+GraphFile::~GraphFile()
+{
+    close();
+}
+
+bool GraphFile::open(const QString& path)
+{
+    close();
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    return fail("Файлы графа открываются только на little-endian платформах");
+#endif
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(FileHeader))) {
+        return fail("Файл слишком короткий для файла графа");
+    }
+
+    // Отображаем весь файл: дальше вершины и ребра читаются прямо из страниц файла
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        return fail(m_file.errorString());
+    }
+
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        return fail("Это не файл графа");
+    }
+    if (header.version != Version) {
+        return fail(QString("Неподдерживаемая версия файла графа: %1").arg(header.version));
+    }
+    if (header.headerSize < sizeof(FileHeader)) {
+        return fail("Поврежденный заголовок файла графа");
+    }
+
+    const quint64 size = quint64(m_size);
+    if (header.vertexCount > quint64(std::numeric_limits<int>::max())
+        || header.edgeCount > quint64(std::numeric_limits<int>::max())
+        || !blockFits(header.vertexOffset, header.vertexCount, sizeof(GraphVertex), size)
+        || !blockFits(header.edgeOffset, header.edgeCount, sizeof(GraphEdge), size)) {
+        return fail("Блоки вершин или ребер выходят за пределы файла");
+    }
+
+    m_graph.vertices = reinterpret_cast<const GraphVertex*>(m_data + header.vertexOffset);
+    m_graph.edges = reinterpret_cast<const GraphEdge*>(m_data + header.edgeOffset);
+    m_graph.numVertices = int(header.vertexCount);
+    m_graph.numEdges = int(header.edgeCount);
+
+    // Концы ребер - индексы в блоке вершин. Проверяем их здесь, а не при постройке сцены:
+    // битый файл не должен успеть заменить собой граф, открытый в окне
+    for (int i = 0; i < m_graph.numEdges; ++i) {
+        const GraphEdge& e = m_graph.edges[i];
+        if (e.source < 0 || e.source >= m_graph.numVertices || e.target < 0 || e.target >= m_graph.numVertices) {
+            return fail(QString("Ребро %1 ссылается на несуществующую вершину").arg(i));
+        }
+    }
+
+    // Трассы необязательны: поврежденное оглавление - ошибка, отсутствие - нет
+    if (header.traceCount > 0) {
+        if (!blockFits(header.traceOffset, header.traceCount, sizeof(TraceHeader), size)) {
+            return fail("Оглавление трасс выходит за пределы файла");
+        }
+
+        for (quint32 i = 0; i < header.traceCount; ++i) {
+            TraceHeader th;
+            std::memcpy(&th, m_data + header.traceOffset + i * sizeof(TraceHeader), sizeof(th));
+
+            if (th.paletteSize > 256
+                || !blockFits(th.paletteOffset, th.paletteSize, sizeof(QRgb), size)
+                || !blockFits(th.stepsOffset, th.stepCount, sizeof(PackedStep), size)) {
+                return fail(QString("Трасса %1 выходит за пределы файла").arg(i));
+            }
+
+            TraceRef ref;
+            ref.name = QString::fromUtf8(th.name, int(qstrnlen(th.name, sizeof(th.name))));
+            ref.palette = reinterpret_cast<const QRgb*>(m_data + th.paletteOffset);
+            ref.paletteSize = int(th.paletteSize);
+            ref.steps = reinterpret_cast<const PackedStep*>(m_data + th.stepsOffset);
+            ref.stepCount = qsizetype(th.stepCount);
+            m_traces.append(ref);
+        }
+    }
+
+    m_error.clear();
+    return true;
+}
+
+void GraphFile::close()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+
+    m_size = 0;
+    m_graph = GraphSpan();
+    m_traces.clear();
+}
+
+QString GraphFile::traceName(int index) const
+{
+    return m_traces.value(index).name;
+}
+
+AlgorithmTrace GraphFile::trace(int index) const
+{
+    if (index < 0 || index >= m_traces.size()) return AlgorithmTrace();
+
+    const TraceRef& ref = m_traces[index];
+    return AlgorithmTrace::fromPacked(ref.steps, ref.stepCount, ref.palette, ref.paletteSize);
+}
+
+bool GraphFile::fail(const QString& message)
+{
+    close();
+    m_error = message;
+    return false;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include "GraphStore.h"
+#include "AlgorithmTrace.h"
+
+// Двоичный файл графа (.gvg). Все числа little-endian, блоки выровнены по 8 байт:
+//   заголовок      magic "GVGF", версия, размеры и смещения блоков
+//   вершины        vertexCount записей GraphVertex {id, x, y}           - по 12 байт
+//   ребра          edgeCount записей GraphEdge {source, target, weight} - по 12 байт,
+//                  концы ребра - индексы в блоке вершин
+//   трассы         (необязательно) оглавление, затем у каждой палитра (QRgb) и шаги (PackedStep)
+// Вершины и ребра лежат в файле в том же виде, в каком их читает решатель,
+// поэтому открытый файл отображается в память и отдается решателю без копирования
+class GraphFile
+{
+public:
+    static constexpr quint32 Version = 1;
+
+    // Сохраненный прогон алгоритма
+    struct Trace {
+        QString name;          // до 31 байта UTF-8, длиннее - обрезается
+        AlgorithmTrace steps;
+    };
+
+    // Записать граф и трассы. false - ошибка, текст в errorString (если передан)
+    static bool save(const QString& path, const GraphSpan& graph, const QList<Trace>& traces,
+        QString* errorString = nullptr);
+
+    GraphFile() = default;
+    ~GraphFile();
+
+    GraphFile(const GraphFile&) = delete;
+    GraphFile& operator=(const GraphFile&) = delete;
+
+    // Открыть и отобразить файл в память. Проверяются заголовок, границы блоков
+    // и концы всех ребер. false - ошибка, см. errorString()
+    bool open(const QString& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    QString errorString() const { return m_error; }
+
+    // Граф прямо в отображенной памяти (действителен, пока файл открыт)
+    GraphSpan graph() const { return m_graph; }
+
+    int traceCount() const { return int(m_traces.size()); }
+    QString traceName(int index) const;
+    AlgorithmTrace trace(int index) const; // шаги копируются в блоки трассы
+
+private:
+    struct TraceRef {
+        QString name;
+        const QRgb* palette;
+        int paletteSize;
+        const PackedStep* steps;
+        qsizetype stepCount;
+    };
+
+    bool fail(const QString& message);
+
+    QFile m_file;
+    uchar* m_data = nullptr;
+    qint64 m_size = 0;
+
+    GraphSpan m_graph;
+    QList<TraceRef> m_traces;
+    QString m_error;
+};
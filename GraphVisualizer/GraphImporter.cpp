@@ -0,0 +1,513 @@
+﻿#include "GraphImporter.h"
+
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Кусок не меньше мегабайта: на мелких кусках запуск задач съедает выигрыш
+const qint64 MinChunkSize = 1 << 20;
+// Кусков больше, чем потоков: строки неровные, так потоки не простаивают
+const int ChunksPerThread = 4;
+// Плотная таблица перенумерации, если разброс ID не больше стольких значений на ребро
+const qint64 DenseRangePerEdge = 4;
+const qint64 DenseRangeMin = 1 << 20;
+
+struct RawEdge {
+    qint64 u;       // ID из файла, как есть
+    qint64 v;
+    qint32 weight;
+};
+
+struct EdgeKey {
+    quint64 key;    // (меньший индекс << 32) | больший индекс
+    qint32 weight;
+};
+
+bool keyLess(const EdgeKey& a, const EdgeKey& b)
+{
+    return a.key < b.key || (a.key == b.key && a.weight < b.weight);
+}
+
+bool sameKey(const EdgeKey& a, const EdgeKey& b)
+{
+    return a.key == b.key;
+}
+
+// Кусок текста, целиком из строк, и то, что из него получилось
+struct Chunk {
+    const char* begin;
+    const char* end;
+
+    std::vector<RawEdge> edges;
+    qint64 lines = 0;
+    qint64 minId = std::numeric_limits<qint64>::max();
+    qint64 maxId = std::numeric_limits<qint64>::min();
+    const char* error = nullptr;   // начало первой неразобранной строки
+
+    std::vector<EdgeKey> keys;     // после перенумерации: отсортированы, без повторов
+    qint64 loops = 0;
+};
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const void* nl = std::memchr(p, '\n', size_t(end - p));
+    return nl ? static_cast<const char*>(nl) : end;
+}
+
+inline bool isComment(char c, GraphImporter::Format format)
+{
+    if (format == GraphImporter::Format::Dimacs) return c == 'c';
+    return c == '%' || (format == GraphImporter::Format::EdgeList && c == '#');
+}
+
+// ID вершины: std::from_chars - без локали, без выделения памяти
+inline const char* parseId(const char* p, const char* end, qint64& value)
+{
+    const auto result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// Вес обычно целый; дробный (Matrix Market real) округляем до целого
+const char* parseWeight(const char* p, const char* end, qint32& weight)
+{
+    const qint64 low = std::numeric_limits<qint32>::min();
+    const qint64 high = std::numeric_limits<qint32>::max();
+
+    qint64 whole = 0;
+    const auto result = std::from_chars(p, end, whole);
+    if (result.ec == std::errc() && (result.ptr == end || (*result.ptr != '.' && *result.ptr != 'e' && *result.ptr != 'E'))) {
+        weight = qint32(qBound(low, whole, high));
+        return result.ptr;
+    }
+
+    double real = 0;
+    const auto realResult = std::from_chars(p, end, real);
+    if (realResult.ec != std::errc()) return nullptr;
+    weight = qint32(qBound(double(low), std::round(real), double(high)));
+    return realResult.ptr;
+}
+
+void parseChunk(Chunk& chunk, GraphImporter::Format format)
+{
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* end = lineEnd(p, chunk.end);
+        const char* q = skipBlanks(p, end);
+
+        if (q < end && !isComment(*q, format)) {
+            // DIMACS: дуга "a u v w" или ребро "e u v"
+            if (format == GraphImporter::Format::Dimacs) {
+                q = (*q == 'a' || *q == 'e') ? q + 1 : nullptr;
+            }
+
+            RawEdge edge = { 0, 0, 1 };
+            if (q) q = parseId(skipBlanks(q, end), end, edge.u);
+            if (q) q = parseId(skipBlanks(q, end), end, edge.v);
+            if (q) {
+                // Вес необязателен; всё после него (метки времени и т.п.) игнорируем
+                q = skipBlanks(q, end);
+                if (q < end && (std::isdigit(uchar(*q)) || *q == '-' || *q == '.')) {
+                    q = parseWeight(q, end, edge.weight);
+                }
+            }
+
+            if (!q) {
+                chunk.error = p;
+                return;
+            }
+
+            chunk.edges.push_back(edge);
+            chunk.minId = qMin(chunk.minId, qMin(edge.u, edge.v));
+            chunk.maxId = qMax(chunk.maxId, qMax(edge.u, edge.v));
+            chunk.lines++;
+        }
+
+        p = end + 1;
+    }
+}
+
+// Пары соседних отсортированных отрезков для одного раунда слияния
+struct MergeRange {
+    qsizetype begin;
+    qsizetype middle;
+    qsizetype end;
+};
+
+}
+
+double GraphImporter::Stats::megabytesPerSecond() const
+{
+    return parseMs > 0 ? (bytes / (1024.0 * 1024.0)) / (parseMs / 1000.0) : 0;
+}
+
+bool GraphImporter::load(const QString& path, Format format)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+
+    const qint64 size = file.size();
+    if (size == 0) {
+        return fail("Файл пуст");
+    }
+
+    // Отображаем файл в память: потоки разбирают его страницы напрямую, без копии
+    uchar* mapped = file.map(0, size);
+    if (mapped) {
+        const bool ok = loadData(reinterpret_cast<const char*>(mapped), size, format);
+        file.unmap(mapped);
+        return ok;
+    }
+
+    // Отобразить не вышло (не обычный файл и т.п.) - читаем целиком
+    const QByteArray bytes = file.readAll();
+    return loadData(bytes.constData(), bytes.size(), format);
+}
+
+bool GraphImporter::loadData(const char* data, qint64 size, Format format)
+{
+    QElapsedTimer total;
+    total.start();
+
+    m_graph.clear();
+    m_stats = Stats();
+    m_stats.bytes = size;
+    m_error.clear();
+    m_canceled = false;
+
+    Header header;
+    if (!parseHeader(data, size, format, header)) return false;
+    format = header.format;
+
+    // 1. Режем тело на куски по границам строк
+    const char* bodyBegin = data + header.bodyOffset;
+    const char* bodyEnd = data + size;
+    const qint64 bodySize = bodyEnd - bodyBegin;
+    const qint64 maxChunks = qint64(qMax(1, QThread::idealThreadCount())) * ChunksPerThread;
+    const qint64 chunkCount = qBound<qint64>(1, bodySize / MinChunkSize, maxChunks);
+
+    std::vector<Chunk> chunks;
+    chunks.reserve(size_t(chunkCount));
+    const char* p = bodyBegin;
+    for (qint64 i = 1; i <= chunkCount && p < bodyEnd; ++i) {
+        const char* end = bodyEnd;
+        if (i < chunkCount) {
+            end = qMax(p, bodyBegin + bodySize * i / chunkCount);
+            end = qMin(bodyEnd, lineEnd(end, bodyEnd) + 1);
+        }
+
+        Chunk chunk;
+        chunk.begin = p;
+        chunk.end = end;
+        chunks.push_back(std::move(chunk));
+        p = end;
+    }
+    m_stats.chunks = int(chunks.size());
+
+    // Ход: каждый кусок разбирается и сортируется (по единице), плюс слияние и сборка графа.
+    // Отмену замечаем между кусками - кусок разбирается за доли секунды
+    const qint64 progressTotal = 2 * qint64(chunks.size()) + 2;
+    std::atomic<qint64> progressDone{ 0 };
+    std::atomic<bool> canceled{ false };
+    auto advance = [&]() {
+        if (m_progress && !m_progress(++progressDone, progressTotal)) canceled = true;
+        return !canceled;
+    };
+    auto cancel = [this]() {
+        m_canceled = true;
+        return fail("Импорт прерван");
+    };
+
+    // 2. Разбираем куски параллельно
+    QElapsedTimer parse;
+    parse.start();
+    QtConcurrent::blockingMap(chunks, [format, &canceled, &advance](Chunk& chunk) {
+        if (canceled) return;
+        parseChunk(chunk, format);
+        advance();
+    });
+    m_stats.parseMs = parse.nsecsElapsed() / 1e6;
+    if (canceled) return cancel();
+
+    qint64 rawEdges = 0;
+    qint64 minId = std::numeric_limits<qint64>::max();
+    qint64 maxId = std::numeric_limits<qint64>::min();
+    for (const Chunk& chunk : chunks) {
+        if (chunk.error) {
+            const qint64 line = 1 + std::count(data, chunk.error, '\n');
+            return fail(QString("Строка %1: не удалось разобрать ребро").arg(line));
+        }
+        rawEdges += qint64(chunk.edges.size());
+        m_stats.lines += chunk.lines;
+        minId = qMin(minId, chunk.minId);
+        maxId = qMax(maxId, chunk.maxId);
+    }
+
+    if (rawEdges == 0 && header.vertexCount < 0) {
+        return fail("В файле нет ни одного ребра");
+    }
+
+    // 3. ID из файла -> плотный индекс.
+    //    Объявленное число вершин: ID 1..n. Иначе - плотная таблица по диапазону ID,
+    //    а если ID разбросаны слишком широко - отсортированный список уникальных ID
+    const qint64 intMax = std::numeric_limits<int>::max();
+    qint64 vertexCount = 0;
+    std::vector<int> table;
+    std::vector<qint64> sortedIds;
+
+    if (header.vertexCount >= 0) {
+        if (header.vertexCount > intMax) {
+            return fail("Слишком много вершин");
+        }
+        if (rawEdges > 0 && (minId < 1 || maxId > header.vertexCount)) {
+            return fail(QString("ID вершины вне диапазона 1..%1").arg(header.vertexCount));
+        }
+        vertexCount = header.vertexCount;
+    }
+    else if (maxId - minId < qMax(DenseRangeMin, DenseRangePerEdge * rawEdges)) {
+        table.assign(size_t(maxId - minId + 1), -1);
+        for (const Chunk& chunk : chunks) {
+            for (const RawEdge& e : chunk.edges) {
+                table[size_t(e.u - minId)] = 0;
+                table[size_t(e.v - minId)] = 0;
+            }
+        }
+        for (int& slot : table) {
+            if (slot == 0) slot = int(qMin(vertexCount++, intMax));
+        }
+    }
+    else {
+        sortedIds.reserve(size_t(rawEdges * 2));
+        for (const Chunk& chunk : chunks) {
+            for (const RawEdge& e : chunk.edges) {
+                sortedIds.push_back(e.u);
+                sortedIds.push_back(e.v);
+            }
+        }
+        std::sort(sortedIds.begin(), sortedIds.end());
+        sortedIds.erase(std::unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+        vertexCount = qint64(sortedIds.size());
+    }
+
+    if (vertexCount > intMax) {
+        return fail("Слишком много вершин");
+    }
+
+    auto indexOf = [&](qint64 id) -> int {
+        if (header.vertexCount >= 0) return int(id - 1);
+        if (!table.empty()) return table[size_t(id - minId)];
+        return int(std::lower_bound(sortedIds.begin(), sortedIds.end(), id) - sortedIds.begin());
+    };
+
+    // 4. Ребра -> ключи (меньший, больший) параллельно; каждый кусок сортирует свои
+    QtConcurrent::blockingMap(chunks, [&indexOf, &canceled, &advance](Chunk& chunk) {
+        if (canceled) return;
+        chunk.keys.reserve(chunk.edges.size());
+        for (const RawEdge& e : chunk.edges) {
+            int a = indexOf(e.u);
+            int b = indexOf(e.v);
+            if (a == b) {
+                chunk.loops++;
+                continue;
+            }
+            if (a > b) std::swap(a, b);
+            chunk.keys.push_back({ (quint64(a) << 32) | quint32(b), e.weight });
+        }
+        std::vector<RawEdge>().swap(chunk.edges);
+
+        // Внутри ключа - по весу, так что unique оставляет самый легкий из повторов
+        std::sort(chunk.keys.begin(), chunk.keys.end(), keyLess);
+        chunk.keys.erase(std::unique(chunk.keys.begin(), chunk.keys.end(), sameKey), chunk.keys.end());
+        advance();
+    });
+    if (canceled) return cancel();
+
+    // 5. Сливаем отсортированные куски попарно, раунды - параллельно
+    std::vector<EdgeKey> keys;
+    std::vector<qsizetype> bounds = { 0 };
+    for (Chunk& chunk : chunks) {
+        m_stats.skippedLoops += chunk.loops;
+        keys.insert(keys.end(), chunk.keys.begin(), chunk.keys.end());
+        std::vector<EdgeKey>().swap(chunk.keys);
+        bounds.push_back(qsizetype(keys.size()));
+    }
+
+    while (bounds.size() > 2) {
+        QList<MergeRange> ranges;
+        std::vector<qsizetype> merged = { 0 };
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            const qsizetype end = i + 2 < bounds.size() ? bounds[i + 2] : bounds[i + 1];
+            if (i + 2 < bounds.size()) ranges.append({ bounds[i], bounds[i + 1], end });
+            merged.push_back(end);
+        }
+
+        QtConcurrent::blockingMap(ranges, [&keys](const MergeRange& range) {
+            std::inplace_merge(keys.begin() + range.begin, keys.begin() + range.middle, keys.begin() + range.end, keyLess);
+        });
+        bounds.swap(merged);
+    }
+    keys.erase(std::unique(keys.begin(), keys.end(), sameKey), keys.end());
+    if (!advance()) return cancel();
+
+    if (qint64(keys.size()) > intMax) {
+        return fail("Слишком много ребер");
+    }
+    m_stats.skippedDuplicates = rawEdges - m_stats.skippedLoops - qint64(keys.size());
+
+    // 6. Собираем граф. ID вершин - из файла, если влезают в int, иначе номера по порядку
+    const bool keepIds = header.vertexCount >= 0 || (minId >= 0 && maxId <= intMax);
+    m_graph.reserve(int(vertexCount), int(keys.size()));
+
+    if (header.vertexCount >= 0) {
+        for (qint64 i = 0; i < vertexCount; ++i) m_graph.addVertex(int(i + 1));
+    }
+    else if (!table.empty()) {
+        for (size_t r = 0; r < table.size(); ++r) {
+            if (table[r] >= 0) m_graph.addVertex(keepIds ? int(minId + qint64(r)) : m_graph.vertexCount() + 1);
+        }
+    }
+    else {
+        for (qint64 id : sortedIds) m_graph.addVertex(keepIds ? int(id) : m_graph.vertexCount() + 1);
+    }
+
+    for (const EdgeKey& k : keys) {
+        m_graph.addEdge(int(k.key >> 32), int(k.key & 0xffffffffu), k.weight);
+        if (k.weight < 0) m_stats.negativeWeights++;
+    }
+    advance();
+
+    m_stats.totalMs = total.nsecsElapsed() / 1e6;
+    return true;
+}
+
+bool GraphImporter::parseHeader(const char* data, qint64 size, Format format, Header& header)
+{
+    const char* end = data + size;
+    const char* p = data;
+
+    // BOM от редакторов Windows
+    if (size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+
+    // Формат по содержимому: заголовок Matrix Market, строки c/p DIMACS, иначе список ребер
+    if (format == Format::Auto) {
+        format = Format::EdgeList;
+        if (end - p >= 14 && std::memcmp(p, "%%MatrixMarket", 14) == 0) {
+            format = Format::MatrixMarket;
+        }
+        else {
+            for (const char* line = p; line < end; line = lineEnd(line, end) + 1) {
+                const char* q = skipBlanks(line, end);
+                if (q == end || *q == '\n' || *q == '#' || *q == '%') continue;
+                if ((*q == 'c' || *q == 'p') && q + 1 < end && (isBlank(q[1]) || q[1] == '\n')) {
+                    format = Format::Dimacs;
+                }
+                break;
+            }
+        }
+    }
+    header.format = format;
+
+    if (format == Format::EdgeList) {
+        header.bodyOffset = p - data;
+        return true;
+    }
+
+    // Заголовки крошечные - разбираем их обычными строками Qt
+    auto tokens = [&](const char* line) {
+        return QByteArray(line, int(lineEnd(line, end) - line)).simplified().toLower().split(' ');
+    };
+
+    if (format == Format::MatrixMarket) {
+        const QList<QByteArray> banner = tokens(p);
+        if (banner.size() < 5 || banner[0] != "%%matrixmarket" || banner[1] != "matrix") {
+            return fail("Нет заголовка Matrix Market");
+        }
+        if (banner[2] != "coordinate") {
+            return fail("Поддерживаются только разреженные (coordinate) матрицы Matrix Market");
+        }
+        if (banner[3] == "complex") {
+            return fail("Комплексные веса не поддерживаются");
+        }
+
+        // Комментарии, затем строка размеров "строк столбцов ненулевых"
+        for (p = lineEnd(p, end) + 1; p < end; p = lineEnd(p, end) + 1) {
+            const char* q = skipBlanks(p, end);
+            if (q == end || *q == '\n' || *q == '%') continue;
+
+            qint64 rows = 0, cols = 0;
+            q = parseId(q, end, rows);
+            if (q) q = parseId(skipBlanks(q, end), end, cols);
+            if (!q || rows < 0 || cols < 0) {
+                return fail("Не удалось разобрать строку размеров Matrix Market");
+            }
+
+            header.vertexCount = qMax(rows, cols);
+            header.bodyOffset = qMin(size, qint64(lineEnd(p, end) + 1 - data));
+            return true;
+        }
+        return fail("Нет строки размеров Matrix Market");
+    }
+
+    // DIMACS: комментарии, затем "p <тип> <вершин> <ребер>"
+    for (; p < end; p = lineEnd(p, end) + 1) {
+        const char* q = skipBlanks(p, end);
+        if (q == end || *q == '\n' || *q == 'c') continue;
+
+        const QList<QByteArray> problem = tokens(q);
+        bool ok = problem.size() >= 3 && problem[0] == "p";
+        const qint64 vertexCount = ok ? problem[2].toLongLong(&ok) : 0;
+        if (!ok || vertexCount < 0) {
+            return fail("Нет строки \"p\" DIMACS перед ребрами");
+        }
+
+        header.vertexCount = vertexCount;
+        header.bodyOffset = qMin(size, qint64(lineEnd(p, end) + 1 - data));
+        return true;
+    }
+    return fail("Нет строки \"p\" DIMACS");
+}
+
+void GraphImporter::spiralLayout(GraphStore& graph, float spacing, float cx, float cy)
+{
+    // Золотой угол: точки ложатся равномерно, каждая занимает ~spacing^2 площади
+    const float goldenAngle = float(M_PI * (3.0 - std::sqrt(5.0)));
+    for (int i = 0; i < graph.vertexCount(); ++i) {
+        const float r = spacing * std::sqrt(i / float(M_PI));
+        const float angle = i * goldenAngle;
+        graph.vertices[i].x = cx + r * std::cos(angle);
+        graph.vertices[i].y = cy + r * std::sin(angle);
+    }
+}
+
+bool GraphImporter::fail(const QString& message)
+{
+    m_graph.clear();
+    m_error = message;
+    return false;
+}
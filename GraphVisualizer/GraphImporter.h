@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <QString>
+#include <functional>
+
+#include "GraphStore.h"
+
+// Импорт графа из текстовых форматов:
+//   список ребер (SNAP и т.п.)  "u v [вес]" в строке, комментарии # или %, разделители - пробелы, табы, запятые
+//   DIMACS (.gr)                 "p sp n m", дуги "a u v w" (или "e u v"), комментарии c
+//   Matrix Market (.mtx)         "%%MatrixMarket matrix coordinate ...", строка размеров, "i j [значение]"
+// Файл отображается в память и разбирается кусками параллельно (QtConcurrent).
+// Произвольные ID вершин перенумеровываются в плотные индексы 0..n-1.
+// Граф неориентированный, как и в редакторе: петли и повторные ребра выбрасываются
+// (из повторов остается ребро с меньшим весом), порядок ребер - по (меньший конец, больший конец).
+// Результат - обычный GraphStore: его можно сразу отдать решателю (setGraphData) или сцене
+class GraphImporter
+{
+public:
+    enum class Format { Auto, EdgeList, Dimacs, MatrixMarket };
+
+    struct Stats {
+        qint64 bytes = 0;
+        qint64 lines = 0;              // строк с ребрами
+        int chunks = 0;                // кусков, разобранных параллельно
+        double parseMs = 0;            // разбор текста
+        double totalMs = 0;            // разбор + перенумерация + сборка графа
+        qint64 skippedLoops = 0;
+        qint64 skippedDuplicates = 0;
+        qint64 negativeWeights = 0;    // ребер графа с весом < 0 (редактор таких не дает, Дейкстра на них неверна)
+
+        // Скорость разбора текста, МБ/с
+        double megabytesPerSecond() const;
+    };
+
+    // Ход загрузки для индикатора: сделано done из total. Зовется из рабочих потоков.
+    // Вернуть false - прервать загрузку (load() вернет false, canceled() - true)
+    using ProgressFunction = std::function<bool(qint64 done, qint64 total)>;
+    void setProgressFunction(ProgressFunction function) { m_progress = std::move(function); }
+    bool canceled() const { return m_canceled; }
+
+    // false - ошибка, текст в errorString()
+    bool load(const QString& path, Format format = Format::Auto);
+    bool loadData(const char* data, qint64 size, Format format = Format::Auto);
+
+    const GraphStore& graph() const { return m_graph; }
+    GraphStore takeGraph() { return std::move(m_graph); }
+
+    const Stats& stats() const { return m_stats; }
+    QString errorString() const { return m_error; }
+
+    // Начальная раскладка без учета ребер: вершины по спирали подсолнуха вокруг (cx, cy),
+    // примерно spacing между соседями. O(n), годится как старт для силовой раскладки
+    static void spiralLayout(GraphStore& graph, float spacing = 40, float cx = 400, float cy = 300);
+
+private:
+    struct Header {
+        Format format = Format::EdgeList;
+        qint64 bodyOffset = 0;     // где начинаются строки с ребрами
+        qint64 vertexCount = -1;   // объявлено в заголовке (ID 1..n), -1 - не объявлено
+    };
+
+    bool parseHeader(const char* data, qint64 size, Format format, Header& header);
+    bool fail(const QString& message);
+
+    GraphStore m_graph;
+    Stats m_stats;
+    QString m_error;
+    ProgressFunction m_progress;
+    bool m_canceled = false;
+};
@@ -1,357 +1,1405 @@
 #include "GraphSolver.h"
-#include "VertexItem.h"
-#include "Edge.h"
+#include "IndexedHeap.h"
+#include "DisjointSet.h"
 #include <QQueue>
-#include <QSet>
 #include <QStack>
+#include <QHash>
+#include <QtConcurrent/QtConcurrent>
+#include <QtAlgorithms>
+#include <atomic>
+#include <functional>
 #include <limits>
 #include <algorithm>
+#include <map>
+#include <random>
 
 GraphSolver::GraphSolver()
 {
 }
 
-void GraphSolver::setGraphData(QList<VertexItem*> vertices, QList<Edge*> edges)
+void GraphSolver::setGraphData(GraphStore graph)
 {
-    m_vertices = vertices;
-    m_edges = edges;
+    m_ownedGraph = std::move(graph);
+    m_graph = m_ownedGraph.view();
+
+    buildAdjacency();
 }
 
-VertexItem* GraphSolver::findNodeById(int id)
+void GraphSolver::setGraphView(GraphSpan graph)
 {
-    for (VertexItem* v : m_vertices) {
-        if (v->getId() == id) return v;
-    }
-    return nullptr;
+    m_ownedGraph.clear();
+    m_graph = graph;
+
+    buildAdjacency();
 }
 
-QList<Edge*> GraphSolver::getConnectedEdges(VertexItem* node)
+void GraphSolver::buildAdjacency()
 {
-    QList<Edge*> result;
-    for (Edge* edge : m_edges) {
-        //      
-        if (edge->sourceNode() == node || edge->destNode() == node) {
-            result.append(edge);
+    const int vertexCount = m_graph.vertexCount();
+    const int edgeCount = m_graph.edgeCount();
+
+    // 1. Проверяем концы ребер и считаем степени
+    m_edgeSource.assign(edgeCount, -1);
+    m_edgeTarget.assign(edgeCount, -1);
+    m_adjOffsets.assign(vertexCount + 1, 0);
+
+    for (int e = 0; e < edgeCount; ++e) {
+        int u = m_graph.edges[e].source;
+        int v = m_graph.edges[e].target;
+        // ребро к вершине вне графа не учитываем
+        if (u < 0 || v < 0 || u >= vertexCount || v >= vertexCount) continue;
+
+        m_edgeSource[e] = u;
+        m_edgeTarget[e] = v;
+        m_adjOffsets[u + 1]++;
+        if (u != v) m_adjOffsets[v + 1]++; // петля дает одного соседа, а не двух
+    }
+
+    // 2. Степени -> смещения (префиксные суммы)
+    for (int i = 0; i < vertexCount; ++i) {
+        m_adjOffsets[i + 1] += m_adjOffsets[i];
+    }
+
+    // 3. Раскладываем соседей. Идем по ребрам в порядке хранилища,
+    // поэтому порядок обхода соседей такой же, как был у перебора всех ребер
+    m_adjVertex.resize(m_adjOffsets[vertexCount]);
+    m_adjEdge.resize(m_adjOffsets[vertexCount]);
+    std::vector<int> cursor(m_adjOffsets.begin(), m_adjOffsets.end() - 1);
+
+    for (int e = 0; e < edgeCount; ++e) {
+        int u = m_edgeSource[e];
+        int v = m_edgeTarget[e];
+        if (u < 0) continue;
+
+        m_adjVertex[cursor[u]] = v;
+        m_adjEdge[cursor[u]++] = e;
+        if (u != v) {
+            m_adjVertex[cursor[v]] = u;
+            m_adjEdge[cursor[v]++] = e;
         }
     }
-    return result;
 }
 
-// ===  BFS (  ) ===
-QQueue<AlgorithmStep> GraphSolver::runBFS(int startNodeId)
+int GraphSolver::findNodeById(int id) const
 {
-    QQueue<AlgorithmStep> steps;
+    return m_graph.indexOfId(id);
+}
 
-    // 1.    
-    steps.enqueue({ ResetColors, nullptr, Qt::white });
+AlgorithmTrace GraphSolver::collect(StepGenerator& generator)
+{
+    AlgorithmTrace steps;
+    AlgorithmStep step;
+    while (generator.next(step)) {
+        steps.append(step);
+    }
+    return steps;
+}
 
-    VertexItem* startNode = findNodeById(startNodeId);
-    if (!startNode) return steps;
+// === РЕАЛИЗАЦИЯ BFS (Поиск в ширину) ===
+// Одна порция работы - одно ребро текущей вершины
+class GraphSolver::BfsGenerator : public StepGenerator
+{
+public:
+    BfsGenerator(const GraphSolver& solver, int startNodeId)
+        : g(solver), m_startNode(solver.findNodeById(startNodeId))
+    {
+    }
 
-    //    BFS
-    QQueue<VertexItem*> queue;
-    QSet<VertexItem*> visited;
+    qint64 workDone() const override { return m_counters.verticesVisited; }
+    qint64 workTotal() const override { return g.m_graph.vertexCount(); }
+
+protected:
+    bool advance() override
+    {
+        if (m_phase == Start) {
+            // 1. Сбрасываем цвета в начале
+            yieldStep(ResetColors, -1, Qt::white);
+            if (m_startNode < 0) return false;
+
+            // Начальная инициализация (вершины - индексы в хранилище)
+            m_visited.assign(g.m_graph.vertexCount(), 0);
+            m_queue.enqueue(m_startNode);
+            m_visited[m_startNode] = 1;
+
+            // Добавляем шаг анимации: "Покрасить старт в зеленый"
+            yieldStep(HighlightNode, m_startNode, Qt::green);
+            m_phase = Expand;
+            return true;
+        }
 
-    //  
-    queue.enqueue(startNode);
-    visited.insert(startNode);
+        // Берем следующую вершину из очереди
+        if (m_current < 0) {
+            if (m_queue.isEmpty()) return false;
 
-    //   : "   "
-    steps.enqueue({ HighlightNode, startNode, Qt::green });
+            m_current = m_queue.dequeue();
+            m_k = g.m_adjOffsets[m_current];
+            m_counters.verticesVisited++;
+            return true;
+        }
 
-    while (!queue.empty()) {
-        VertexItem* current = queue.dequeue();
+        // Соседи лежат подряд в CSR: разбираем по одному
+        if (m_k < g.m_adjOffsets[m_current + 1]) {
+            const int k = m_k++;
+            m_counters.edgeScans++;
+            const int neighbor = g.m_adjVertex[k];
+
+            if (!m_visited[neighbor]) {
+                m_visited[neighbor] = 1;
+                m_queue.enqueue(neighbor);
+
+                // АНИМАЦИЯ:
+                // 1. Красим ребро, по которому прошли (желтым)
+                yieldStep(HighlightEdge, g.m_adjEdge[k], Qt::yellow);
+                // 2. Красим найденного соседа (желтым, типа "в обработке")
+                yieldStep(HighlightNode, neighbor, Qt::yellow);
+            }
+            return true;
+        }
+
+        // Когда закончили обработку вершины, красим её в "посещенный" (серый)
+        // (кроме стартовой, пусть останется зеленой для красоты)
+        if (m_current != m_startNode) {
+            yieldStep(HighlightNode, m_current, Qt::lightGray);
+        }
+        m_current = -1;
+        return true;
+    }
 
-        //  
-        QList<Edge*> connectedEdges = getConnectedEdges(current);
+private:
+    enum Phase { Start, Expand };
 
-        for (Edge* edge : connectedEdges) {
-            //   (       )
-            VertexItem* neighbor = (edge->sourceNode() == current) ? edge->destNode() : edge->sourceNode();
+    const GraphSolver& g;
+    const int m_startNode;
+    Phase m_phase = Start;
 
-            if (!visited.contains(neighbor)) {
-                visited.insert(neighbor);
-                queue.enqueue(neighbor);
+    QQueue<int> m_queue;
+    std::vector<char> m_visited;
+    int m_current = -1; // вершина, соседей которой сейчас разбираем
+    int m_k = 0;        // позиция в ее списке соседей
+};
 
-                // :
-                // 1.  ,    ()
-                steps.enqueue({ HighlightEdge, edge, Qt::yellow });
-                // 2.    (,  " ")
-                steps.enqueue({ HighlightNode, neighbor, Qt::yellow });
-            }
+// === РЕАЛИЗАЦИЯ DFS (Поиск в глубину) ===
+class GraphSolver::DfsGenerator : public StepGenerator
+{
+public:
+    DfsGenerator(const GraphSolver& solver, int startNodeId)
+        : g(solver), m_startNode(solver.findNodeById(startNodeId))
+    {
+    }
+
+    qint64 workDone() const override { return m_counters.verticesVisited; }
+    qint64 workTotal() const override { return g.m_graph.vertexCount(); }
+
+protected:
+    bool advance() override
+    {
+        if (m_phase == Start) {
+            yieldStep(ResetColors, -1, Qt::white);
+            if (m_startNode < 0) return false;
+
+            // Используем СТЕК вместо Очереди
+            m_visited.assign(g.m_graph.vertexCount(), 0);
+            m_stack.push(m_startNode);
+            m_phase = Expand;
+            return true;
         }
 
-        //    ,    "" ()
-        // ( ,     )
-        if (current != startNode) {
-            steps.enqueue({ HighlightNode, current, Qt::lightGray });
+        if (m_current < 0) {
+            if (m_stack.isEmpty()) return false;
+
+            const int current = m_stack.pop();
+
+            // В DFS мы помечаем вершину посещенной, когда ДОСТАЕМ её из стека
+            if (m_visited[current]) return true;
+            m_visited[current] = 1;
+            m_counters.verticesVisited++;
+
+            // Анимация: текущая вершина обрабатывается
+            // Если это старт - зеленый, иначе - желтый (или оранжевый для отличия от BFS)
+            QColor color = (current == m_startNode) ? Qt::green : Qt::yellow;
+            yieldStep(HighlightNode, current, color);
+
+            // Важный момент: чтобы идти "слева направо", в стек кладут в обратном порядке.
+            // Но для визуализации это не критично.
+            m_current = current;
+            m_k = g.m_adjOffsets[current];
+            return true;
         }
+
+        if (m_k < g.m_adjOffsets[m_current + 1]) {
+            const int k = m_k++;
+            m_counters.edgeScans++;
+            const int neighbor = g.m_adjVertex[k];
+
+            if (!m_visited[neighbor]) {
+                m_stack.push(neighbor);
+
+                // Анимация: подсветим ребро, которое "нашли", но еще не прошли
+                // Сделаем его, например, синим, чтобы отличать от пройденного
+                yieldStep(HighlightEdge, g.m_adjEdge[k], Qt::cyan);
+            }
+            return true;
+        }
+
+        m_current = -1;
+        return true;
     }
 
-    return steps;
+private:
+    enum Phase { Start, Expand };
+
+    const GraphSolver& g;
+    const int m_startNode;
+    Phase m_phase = Start;
+
+    QStack<int> m_stack;
+    std::vector<char> m_visited;
+    int m_current = -1;
+    int m_k = 0;
+};
+
+// Бесконечное расстояние для Дейкстры
+static const qint64 InfiniteDistance = std::numeric_limits<qint64>::max();
+
+// Сложение расстояния и веса без переполнения: сумма "упирается" в бесконечность
+static qint64 addDistance(qint64 distance, int weight)
+{
+    if (weight > 0 && distance > InfiniteDistance - weight) {
+        return InfiniteDistance;
+    }
+    return distance + weight;
 }
 
-// ===  DFS (  ) ===
-QQueue<AlgorithmStep> GraphSolver::runDFS(int startNodeId)
+class GraphSolver::DijkstraGenerator : public StepGenerator
 {
-    QQueue<AlgorithmStep> steps;
-    steps.enqueue({ ResetColors, nullptr, Qt::white });
+public:
+    DijkstraGenerator(const GraphSolver& solver, int startNodeId)
+        : g(solver), m_startNode(solver.findNodeById(startNodeId))
+    {
+    }
+
+    qint64 workDone() const override { return m_counters.verticesVisited; }
+    qint64 workTotal() const override { return g.m_graph.vertexCount(); }
+
+protected:
+    bool advance() override
+    {
+        if (m_phase == Start) {
+            yieldStep(ResetColors, -1, Qt::white);
+            if (m_startNode < 0) return false;
+
+            // 1. Инициализация
+            // Расстояния и ребра-родители храним плоскими массивами по индексам вершин.
+            // Ребро-родитель нужно, чтобы покрасить ребро, входящее в кратчайшее дерево
+            const int vertexCount = g.m_graph.vertexCount();
+            m_distances.assign(vertexCount, InfiniteDistance);
+            m_parentEdge.assign(vertexCount, -1);
+            m_settled.assign(vertexCount, 0);
+
+            // В куче лежат только достигнутые, но еще не закрепленные вершины
+            m_heap.reset(vertexCount);
+            m_distances[m_startNode] = 0;
+            m_heap.push(m_startNode, 0);
+
+            m_phase = Settle;
+            return true;
+        }
 
-    VertexItem* startNode = findNodeById(startNodeId);
-    if (!startNode) return steps;
+        if (m_current < 0) {
+            if (m_heap.isEmpty()) return false;
 
-    //    
-    QStack<VertexItem*> stack;
-    QSet<VertexItem*> visited;
+            // 2. Достаем вершину с минимальным расстоянием
+            // (при равенстве - с меньшим индексом, как и при линейном поиске)
+            const int current = m_heap.popMin();
+            m_settled[current] = 1;
+            m_counters.verticesVisited++;
 
-    stack.push(startNode);
+            // Анимация: "Мы закрепили эту вершину" (Зеленый - финал)
+            yieldStep(HighlightNode, current, Qt::green);
 
-    while (!stack.isEmpty()) {
-        VertexItem* current = stack.pop();
+            // Если мы пришли в эту вершину по какому-то ребру, красим это ребро в "хороший" путь
+            if (m_parentEdge[current] >= 0) {
+                yieldStep(HighlightEdge, m_parentEdge[current], Qt::green);
+            }
 
-        //  DFS    ,     
-        if (!visited.contains(current)) {
-            visited.insert(current);
+            m_current = current;
+            m_k = g.m_adjOffsets[current];
+            return true;
+        }
 
-            // :   
-            //    - ,  -  (     BFS)
-            QColor color = (current == startNode) ? Qt::green : Qt::yellow;
-            steps.enqueue({ HighlightNode, current, color });
+        // 3. Релаксация (обновление соседей), по одному ребру
+        if (m_k < g.m_adjOffsets[m_current + 1]) {
+            const int k = m_k++;
+            m_counters.edgeScans++;
+            const int neighbor = g.m_adjVertex[k];
 
-            //  
-            QList<Edge*> connectedEdges = getConnectedEdges(current);
+            // Закрепленные вершины больше не трогаем
+            if (m_settled[neighbor]) return true;
 
-            //  :   " ",      .
-            //      .
+            const int edge = g.m_adjEdge[k];
 
-            for (Edge* edge : connectedEdges) {
-                VertexItem* neighbor = (edge->sourceNode() == current) ? edge->destNode() : edge->sourceNode();
+            // Анимация: "Проверяем ребро" (Желтый)
+            yieldStep(HighlightEdge, edge, Qt::yellow);
 
-                if (!visited.contains(neighbor)) {
-                    stack.push(neighbor);
+            const qint64 newDist = addDistance(m_distances[m_current], g.m_graph.edges[edge].weight);
 
-                    // :  ,  "",    
-                    //  , , ,    
-                    steps.enqueue({ HighlightEdge, edge, Qt::cyan });
-                }
+            // Если нашли путь короче
+            if (newDist < m_distances[neighbor]) {
+                m_distances[neighbor] = newDist;
+                m_counters.relaxations++;
+                m_parentEdge[neighbor] = edge;
+                m_heap.push(neighbor, newDist); // вставка или уменьшение ключа
+
+                // Анимация: "Нашли путь лучше!" (Сосед мигает оранжевым)
+                yieldStep(HighlightNode, neighbor, Qt::darkYellow);
+            }
+            else {
+                // Анимация: "Путь не лучше, возвращаем ребро в черный/серый"
+                // (Опционально, можно не делать, или красить в серый как "отброшенное")
+                yieldStep(HighlightEdge, edge, Qt::lightGray);
             }
+            return true;
         }
+
+        m_current = -1;
+        return true;
     }
 
-    return steps;
-}
+private:
+    enum Phase { Start, Settle };
+
+    const GraphSolver& g;
+    const int m_startNode;
+    Phase m_phase = Start;
+
+    std::vector<qint64> m_distances;
+    std::vector<int> m_parentEdge;
+    std::vector<char> m_settled;
+    IndexedHeap m_heap;
+    int m_current = -1;
+    int m_k = 0;
+};
+
+// Цвета компонент связности - по кругу, если компонент больше (общие для обеих версий)
+static const Qt::GlobalColor ComponentPalette[] = {
+    Qt::red, Qt::blue, Qt::green, Qt::magenta, Qt::darkCyan, Qt::darkYellow
+};
+static const int ComponentPaletteSize = int(sizeof(ComponentPalette) / sizeof(ComponentPalette[0]));
 
-QQueue<AlgorithmStep> GraphSolver::runDijkstra(int startNodeId)
+class GraphSolver::ComponentsGenerator : public StepGenerator
 {
-    QQueue<AlgorithmStep> steps;
-    steps.enqueue({ ResetColors, nullptr, Qt::white });
+public:
+    explicit ComponentsGenerator(const GraphSolver& solver)
+        : g(solver)
+    {
+    }
+
+    qint64 workDone() const override { return m_counters.verticesVisited; }
+    qint64 workTotal() const override { return g.m_graph.vertexCount(); }
+
+protected:
+    bool advance() override
+    {
+        if (m_phase == Start) {
+            yieldStep(ResetColors, -1, Qt::white);
+            m_visited.assign(g.m_graph.vertexCount(), 0);
+            m_phase = Search;
+            return true;
+        }
+
+        if (m_current < 0) {
+            if (m_queue.isEmpty()) {
+                // Пробегаем по ВСЕМ вершинам графа
+                // Если вершину еще не посещали - значит, мы нашли НОВЫЙ островок
+                while (m_nextRoot < g.m_graph.vertexCount() && m_visited[m_nextRoot]) {
+                    m_nextRoot++;
+                }
+                if (m_nextRoot == g.m_graph.vertexCount()) return false;
+
+                // Выбираем цвет. Если цветов мало, начинаем сначала (циклично)
+                m_currentColor = ComponentPalette[m_colorIndex % ComponentPaletteSize];
+                m_colorIndex++;
+
+                // Запускаем локальный BFS, чтобы найти всех жителей этого острова
+                m_queue.enqueue(m_nextRoot);
+                m_visited[m_nextRoot] = 1;
+
+                yieldStep(HighlightNode, m_nextRoot, m_currentColor);
+                return true;
+            }
 
-    VertexItem* startNode = findNodeById(startNodeId);
-    if (!startNode) return steps;
+            m_current = m_queue.dequeue();
+            m_k = g.m_adjOffsets[m_current];
+            m_counters.verticesVisited++;
+            return true;
+        }
 
-    // 1. 
-    //    
-    QMap<VertexItem*, int> distances;
-    //  "  " (   ,  )
-    //      ,      
-    QMap<VertexItem*, Edge*> parentEdge;
+        // Ищем соседей
+        if (m_k < g.m_adjOffsets[m_current + 1]) {
+            const int k = m_k++;
+            m_counters.edgeScans++;
+            const int neighbor = g.m_adjVertex[k];
+            const int edge = g.m_adjEdge[k];
 
-    QList<VertexItem*> unvisitedNodes = m_vertices;
+            if (!m_visited[neighbor]) {
+                m_visited[neighbor] = 1;
+                m_queue.enqueue(neighbor);
 
-    //  
-    for (VertexItem* v : m_vertices) {
-        distances[v] = std::numeric_limits<int>::max(); // 
+                // Красим соседа и ребро в цвет текущей группы
+                yieldStep(HighlightEdge, edge, m_currentColor);
+                yieldStep(HighlightNode, neighbor, m_currentColor);
+            }
+            // Если сосед уже посещен, но ребро еще черное - покрасим его тоже (для красоты)
+            else {
+                // Дополнительная проверка, чтобы не перекрашивать ребра других групп
+                // (упрощенно красим всё внутри группы)
+                yieldStep(HighlightEdge, edge, m_currentColor);
+            }
+            return true;
+        }
+
+        m_current = -1;
+        return true;
     }
-    distances[startNode] = 0;
 
-    while (!unvisitedNodes.isEmpty()) {
-        // 2.       
-        VertexItem* current = nullptr;
-        int minDist = std::numeric_limits<int>::max();
+private:
+    enum Phase { Start, Search };
+
+    const GraphSolver& g;
+    Phase m_phase = Start;
+
+    int m_colorIndex = 0;
+    QColor m_currentColor;
+
+    std::vector<char> m_visited;
+    QQueue<int> m_queue;
+    int m_nextRoot = 0; // все вершины до этой уже разобраны по компонентам
+    int m_current = -1;
+    int m_k = 0;
+};
 
-        for (VertexItem* node : unvisitedNodes) {
-            if (distances[node] < minDist) {
-                minDist = distances[node];
-                current = node;
+// Одна порция работы - одно ребро из отсортированного списка
+class GraphSolver::KruskalGenerator : public StepGenerator
+{
+public:
+    explicit KruskalGenerator(const GraphSolver& solver)
+        : g(solver)
+    {
+    }
+
+    // Прогресс - доля просмотренных ребер (до сортировки - ноль)
+    qint64 workDone() const override { return qint64(m_position); }
+    qint64 workTotal() const override { return qint64(m_sortedEdges.size()); }
+
+protected:
+    bool advance() override
+    {
+        const int vertexCount = g.m_graph.vertexCount();
+
+        if (m_phase == Start) {
+            yieldStep(ResetColors, -1, Qt::white);
+
+            // 1. Инициализация DSU
+            // Изначально каждая вершина - сама себе начальник (отдельное множество)
+            m_sets.reset(vertexCount);
+
+            // 2. Сортировка ребер
+            // Сортируем не сами ребра, а пары (вес, индекс ребра): сравнение не ходит по указателям,
+            // а при равных весах порядок детерминирован (как в хранилище)
+            m_sortedEdges.reserve(g.m_graph.edgeCount());
+            for (int e = 0; e < g.m_graph.edgeCount(); ++e) {
+                if (g.m_edgeSource[e] < 0) continue;
+                m_sortedEdges.push_back({ g.m_graph.edges[e].weight, e });
             }
+            std::sort(m_sortedEdges.begin(), m_sortedEdges.end());
+
+            m_phase = Scan;
+            return true;
         }
 
-        //      () - 
-        if (current == nullptr || minDist == std::numeric_limits<int>::max()) {
-            break;
+        // 3. Главный цикл
+        // Остов уже содержит V-1 ребро - остальные ребра рассматривать незачем
+        if (m_position >= m_sortedEdges.size() || m_edgesCount >= vertexCount - 1) {
+            return false;
         }
 
-        //   
-        unvisitedNodes.removeOne(current);
+        const int edge = m_sortedEdges[m_position++].second;
+        m_counters.edgeScans++;
 
-        // : "   " ( - )
-        steps.enqueue({ HighlightNode, current, Qt::green });
+        // Анимация: "Рассматриваем текущее ребро" (Желтый)
+        yieldStep(HighlightEdge, edge, Qt::yellow);
 
-        //        - ,     "" 
-        if (parentEdge.contains(current)) {
-            steps.enqueue({ HighlightEdge, parentEdge[current], Qt::green });
+        const int u = g.m_edgeSource[edge];
+        const int v = g.m_edgeTarget[edge];
+
+        // Проверяем, в одной ли они группе, и если в РАЗНЫХ - сразу объединяем
+        if (m_sets.unite(u, v)) {
+            // Анимация: "Берем!" (Зеленый)
+            yieldStep(HighlightEdge, edge, Qt::green);
+            // Подсветим вершины тоже, чтобы было видно, что они теперь в дереве
+            yieldStep(HighlightNode, u, Qt::green);
+            yieldStep(HighlightNode, v, Qt::green);
+
+            m_edgesCount++;
+        }
+        else {
+            // Если в ОДНОЙ -> Это цикл, выкидываем
+            // Анимация: "Не берем!" (Красный или Серый)
+            yieldStep(HighlightEdge, edge, Qt::red); // Красный нагляднее: "Опасность, цикл!"
         }
+        return true;
+    }
+
+private:
+    enum Phase { Start, Scan };
+
+    const GraphSolver& g;
+    Phase m_phase = Start;
+
+    DisjointSet m_sets;
+    std::vector<std::pair<int, int>> m_sortedEdges;
+    size_t m_position = 0;
+    int m_edgesCount = 0; // Сколько ребер мы взяли (для остановки, когда V-1)
+};
+
+// Генератор поверх готовой трассы: параллельный алгоритм считает всё разом
+// при первом advance(), а потом отдает шаги по одному, как и пошаговые
+class GraphSolver::PrecomputedGenerator : public StepGenerator
+{
+public:
+    using Compute = std::function<AlgorithmTrace(SolverCounters& counters)>;
+
+    explicit PrecomputedGenerator(Compute compute)
+        : m_compute(std::move(compute))
+    {
+    }
 
-        // 3.  ( )
-        QList<Edge*> edges = getConnectedEdges(current);
+    // До расчета прогресс нулевой, дальше - доля отданных шагов
+    qint64 workDone() const override { return m_position; }
+    qint64 workTotal() const override { return m_trace.size(); }
 
-        for (Edge* edge : edges) {
-            VertexItem* neighbor = (edge->sourceNode() == current) ? edge->destNode() : edge->sourceNode();
+protected:
+    bool advance() override
+    {
+        if (!m_computed) {
+            m_trace = m_compute(m_counters);
+            m_computed = true;
+        }
+        if (m_position >= m_trace.size()) return false;
+
+        const AlgorithmStep step = m_trace.at(m_position++);
+        yieldStep(step.type, step.index, step.color);
+        return true;
+    }
 
-            //     
-            if (unvisitedNodes.contains(neighbor)) {
-                // : " " ()
-                steps.enqueue({ HighlightEdge, edge, Qt::yellow });
+private:
+    Compute m_compute;
+    bool m_computed = false;
+    AlgorithmTrace m_trace;
+    qsizetype m_position = 0;
+};
+
+// === ПАРАЛЛЕЛЬНЫЙ BFS ПО УРОВНЯМ ===
+// Beamer et al., "Direction-Optimizing Breadth-First Search". Уровень обходится
+//   сверху вниз: вершины фронта смотрят соседей и захватывают непосещенных;
+//   снизу вверх: каждая непосещенная вершина ищет соседа во фронте и останавливается
+//                на первом найденном - на большом фронте это почти всегда рано.
+// Фронт сверху вниз - список вершин, снизу вверх - битовая карта
+namespace {
+
+// Вниз -> вверх, когда у фронта ребер больше 1/BfsAlpha ребер непосещенных вершин;
+// обратно - когда фронт уже сжимается и в нем меньше n/BfsBeta вершин (значения из статьи)
+const qint64 BfsAlpha = 14;
+const qint64 BfsBeta = 24;
+
+// Задача пула: столько вершин фронта (сверху вниз) или графа (снизу вверх).
+// Задачи мелкие, чтобы освободившиеся потоки пула добирали работу за занятыми
+// (хаб степенного графа не держит весь уровень). VertexBlockSize кратен 64:
+// слово битовой карты целиком принадлежит одной задаче
+const int FrontierBlockSize = 256;
+const int VertexBlockSize = 4096;
+// Уровень меньше этого (в ребрах) считаем в текущем потоке: пул дороже самой работы
+const qint64 MinParallelEdges = 16384;
+
+// Битовая карта вершин. trySet атомарный - захват вершины из разных потоков
+class AtomicBitmap
+{
+public:
+    explicit AtomicBitmap(int size)
+        : m_words((size_t(size) + 63) / 64)
+    {
+    }
 
-                int weight = edge->getWeight();
-                int newDist = distances[current] + weight;
+    bool test(int i) const
+    {
+        return (m_words[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+    }
 
-                //    
-                if (newDist < distances[neighbor]) {
-                    distances[neighbor] = newDist;
-                    parentEdge[neighbor] = edge;
+    // true - бит был снят и его поставили мы
+    bool trySet(int i)
+    {
+        const quint64 bit = quint64(1) << (i & 63);
+        return !(m_words[i >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+    }
 
-                    // : "  !" (  )
-                    steps.enqueue({ HighlightNode, neighbor, Qt::darkYellow });
+    void clear()
+    {
+        for (std::atomic<quint64>& word : m_words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t wordCount() const { return m_words.size(); }
+    quint64 word(size_t w) const { return m_words[w].load(std::memory_order_relaxed); }
+
+    void swap(AtomicBitmap& other) { m_words.swap(other.m_words); }
+
+private:
+    std::vector<std::atomic<quint64>> m_words;
+};
+
+// Задача уровня: отрезок фронта или вершин и ее итоги
+struct BfsBlock {
+    int begin;
+    int end;
+    std::vector<int> found;     // сверху вниз: захваченные вершины
+    qint64 foundCount = 0;
+    qint64 foundEdges = 0;      // сумма степеней найденных вершин
+    qint64 scans = 0;
+};
+
+// Разбить [0, count) на задачи (у блока есть begin/end, остальное - итоги задачи)
+template <class Block>
+void splitBlocks(std::vector<Block>& blocks, int count, int blockSize)
+{
+    blocks.clear();
+    for (int begin = 0; begin < count; begin += blockSize) {
+        Block block;
+        block.begin = begin;
+        block.end = qMin(count, begin + blockSize);
+        blocks.push_back(std::move(block));
+    }
+}
+
+template <class Block, class Function>
+void runBlocks(std::vector<Block>& blocks, qint64 work, Function function)
+{
+    if (blocks.size() > 1 && work >= MinParallelEdges) {
+        QtConcurrent::blockingMap(blocks, function);
+    }
+    else {
+        for (Block& block : blocks) function(block);
+    }
+}
+
+}
+
+GraphSolver::BfsResult GraphSolver::runParallelBFS(int startNodeId, bool withTrace) const
+{
+    const int n = m_graph.vertexCount();
+
+    BfsResult result;
+    result.level.assign(n, -1);
+    result.parent.assign(n, -1);
+    result.parentEdge.assign(n, -1);
+
+    const int start = findNodeById(startNodeId);
+    if (start < 0) {
+        if (withTrace) result.trace.append({ ResetColors, -1, Qt::white });
+        return result;
+    }
+
+    const int* offsets = m_adjOffsets.data();
+    const int* adjVertex = m_adjVertex.data();
+    const int* adjEdge = m_adjEdge.data();
+    int* level = result.level.data();
+    int* parent = result.parent.data();
+    int* parentEdge = result.parentEdge.data();
+    auto degree = [offsets](int v) { return qint64(offsets[v + 1] - offsets[v]); };
+
+    AtomicBitmap visited(n);
+    AtomicBitmap frontierBits(n);
+    AtomicBitmap nextBits(n);
+
+    std::vector<int> frontier = { start };
+    visited.trySet(start);
+    level[start] = 0;
+
+    qint64 frontierCount = 1;
+    qint64 frontierEdges = degree(start);
+    qint64 unexploredEdges = qint64(m_adjVertex.size()) - frontierEdges;
+    bool bottomUp = false;
+    bool growing = true;
+    int depth = 0;
+
+    std::vector<BfsBlock> blocks;
+
+    while (frontierCount > 0) {
+        // 1. Направление уровня (и перевод фронта в нужный вид)
+        if (!bottomUp && frontierEdges > unexploredEdges / BfsAlpha) {
+            bottomUp = true;
+            frontierBits.clear();
+            for (int v : frontier) frontierBits.trySet(v);
+        }
+        else if (bottomUp && !growing && frontierCount < n / BfsBeta) {
+            bottomUp = false;
+            frontier.clear();
+            for (size_t w = 0; w < frontierBits.wordCount(); ++w) {
+                for (quint64 bits = frontierBits.word(w); bits; bits &= bits - 1) {
+                    frontier.push_back(int(w * 64) + qCountTrailingZeroBits(bits));
                 }
-                else {
-                    // : "  ,    /"
-                    // (,   ,      "")
-                    steps.enqueue({ HighlightEdge, edge, Qt::lightGray });
+            }
+        }
+
+        const int nextLevel = depth + 1;
+
+        if (!bottomUp) {
+            // 2а. Сверху вниз: кто первым поставил бит, тот и родитель
+            splitBlocks(blocks, int(frontier.size()), FrontierBlockSize);
+            runBlocks(blocks, frontierEdges, [&](BfsBlock& block) {
+                for (int i = block.begin; i < block.end; ++i) {
+                    const int u = frontier[i];
+                    for (int k = offsets[u]; k < offsets[u + 1]; ++k) {
+                        block.scans++;
+                        const int v = adjVertex[k];
+                        if (visited.test(v) || !visited.trySet(v)) continue;
+
+                        level[v] = nextLevel;
+                        parent[v] = u;
+                        parentEdge[v] = adjEdge[k];
+                        block.found.push_back(v);
+                        block.foundEdges += degree(v);
+                    }
                 }
+                block.foundCount = qint64(block.found.size());
+            });
+
+            frontier.clear();
+            for (const BfsBlock& block : blocks) {
+                frontier.insert(frontier.end(), block.found.begin(), block.found.end());
             }
         }
+        else {
+            // 2б. Снизу вверх: вершина сама ищет родителя во фронте. Свои вершины задача
+            // пишет одна (и их слова битовых карт тоже), так что гонок нет
+            splitBlocks(blocks, n, VertexBlockSize);
+            runBlocks(blocks, unexploredEdges, [&](BfsBlock& block) {
+                for (int v = block.begin; v < block.end; ++v) {
+                    if (visited.test(v)) continue;
+
+                    for (int k = offsets[v]; k < offsets[v + 1]; ++k) {
+                        block.scans++;
+                        const int u = adjVertex[k];
+                        if (!frontierBits.test(u)) continue;
+
+                        level[v] = nextLevel;
+                        parent[v] = u;
+                        parentEdge[v] = adjEdge[k];
+                        visited.trySet(v);
+                        nextBits.trySet(v);
+                        block.foundCount++;
+                        block.foundEdges += degree(v);
+                        break;
+                    }
+                }
+            });
+
+            frontierBits.swap(nextBits);
+            nextBits.clear();
+            result.bottomUpLevels++;
+        }
+
+        // 3. Итоги уровня
+        const qint64 previousCount = frontierCount;
+        frontierCount = 0;
+        frontierEdges = 0;
+        for (const BfsBlock& block : blocks) {
+            frontierCount += block.foundCount;
+            frontierEdges += block.foundEdges;
+            result.counters.edgeScans += block.scans;
+        }
+        unexploredEdges -= frontierEdges;
+
+        growing = frontierCount > previousCount;
+
+        if (frontierCount > 0) depth = nextLevel;
+        result.counters.verticesVisited += previousCount;
     }
 
-    return steps;
+    result.depth = depth;
+    if (withTrace) result.trace = levelTrace(result, start);
+    return result;
 }
 
-QQueue<AlgorithmStep> GraphSolver::runConnectedComponents()
+AlgorithmTrace GraphSolver::levelTrace(const BfsResult& result, int start) const
 {
-    QQueue<AlgorithmStep> steps;
-    steps.enqueue({ ResetColors, nullptr, Qt::white });
+    AlgorithmTrace trace;
+    trace.append({ ResetColors, -1, Qt::white });
+    trace.append({ HighlightNode, start, Qt::green });
+
+    // Вершины по уровням, внутри уровня - по индексу (порядок не зависит от потоков)
+    std::vector<int> levelStart(result.depth + 2, 0);
+    for (int l : result.level) {
+        if (l >= 0) levelStart[l + 1]++;
+    }
+    for (int l = 0; l <= result.depth; ++l) {
+        levelStart[l + 1] += levelStart[l];
+    }
 
-    QSet<VertexItem*> visited;
+    std::vector<int> byLevel(levelStart.back());
+    std::vector<int> cursor(levelStart.begin(), levelStart.end() - 1);
+    for (int v = 0; v < int(result.level.size()); ++v) {
+        if (result.level[v] >= 0) byLevel[cursor[result.level[v]]++] = v;
+    }
+
+    // Как в пошаговом BFS: найденная вершина и ребро к ней - желтым, разобранная - серым
+    // (старт остается зеленым). Только на уровень целиком, без проверок отдельных ребер
+    for (int l = 1; l <= result.depth + 1; ++l) {
+        if (l <= result.depth) {
+            for (int i = levelStart[l]; i < levelStart[l + 1]; ++i) {
+                const int v = byLevel[i];
+                trace.append({ HighlightEdge, result.parentEdge[v], Qt::yellow });
+                trace.append({ HighlightNode, v, Qt::yellow });
+            }
+        }
+        for (int i = levelStart[l - 1]; i < levelStart[l]; ++i) {
+            if (byLevel[i] != start) trace.append({ HighlightNode, byLevel[i], Qt::lightGray });
+        }
+    }
+    return trace;
+}
 
-    //      (  )
-    QList<QColor> palette = {
-        Qt::red, Qt::blue, Qt::green, Qt::magenta, Qt::darkCyan, Qt::darkYellow
+// === ПАРАЛЛЕЛЬНЫЕ КОМПОНЕНТЫ СВЯЗНОСТИ ===
+// Afforest (Sutton et al.): лес непересекающихся множеств в одном массиве comp,
+// корни подвешиваются друг к другу без блокировок (CAS), всегда больший под меньший.
+//   1. Каждая вершина связывается с первыми AfforestNeighborRounds соседями.
+//   2. По выборке вершин находим самую большую компоненту - обычно гигантскую.
+//   3. Остальных соседей просматривают только вершины вне нее: ребра внутри
+//      гигантской компоненты (их большинство) больше не трогаются
+namespace {
+
+const int AfforestNeighborRounds = 2;
+const int AfforestSamples = 1024;
+// Вершин на задачу пула
+const int ComponentBlockSize = 4096;
+
+// Вызвать function(begin, end) для отрезков [0, count) в пуле потоков
+template <class Function>
+void forEachBlock(int count, Function function)
+{
+    struct Range {
+        int begin;
+        int end;
     };
-    int colorIndex = 0;
 
-    //     
-    for (VertexItem* node : m_vertices) {
+    std::vector<Range> ranges;
+    for (int begin = 0; begin < count; begin += ComponentBlockSize) {
+        ranges.push_back({ begin, qMin(count, begin + ComponentBlockSize) });
+    }
+
+    if (ranges.size() > 1) {
+        QtConcurrent::blockingMap(ranges, [&function](const Range& range) { function(range.begin, range.end); });
+    }
+    else if (count > 0) {
+        function(0, count);
+    }
+}
 
-        //      - ,    
-        if (!visited.contains(node)) {
+using ComponentArray = std::vector<std::atomic<int>>;
 
-            //  .   ,   ()
-            QColor currentColor = palette[colorIndex % palette.size()];
-            colorIndex++;
+// Объединить множества u и v: корень с большим номером подвешивается под меньший.
+// Проигравший CAS (корень успели подвесить) просто поднимается выше и пробует снова
+void link(ComponentArray& comp, int u, int v)
+{
+    int p1 = comp[u].load(std::memory_order_relaxed);
+    int p2 = comp[v].load(std::memory_order_relaxed);
 
-            //   BFS/DFS,      
-            //     
-            QQueue<VertexItem*> queue;
-            queue.enqueue(node);
-            visited.insert(node);
+    while (p1 != p2) {
+        const int high = qMax(p1, p2);
+        const int low = qMin(p1, p2);
 
-            steps.enqueue({ HighlightNode, node, currentColor });
+        int expected = high;
+        const int parentOfHigh = comp[high].load(std::memory_order_relaxed);
+        if (parentOfHigh == low) break;
+        if (parentOfHigh == high && comp[high].compare_exchange_strong(expected, low, std::memory_order_relaxed)) break;
 
-            while (!queue.isEmpty()) {
-                VertexItem* current = queue.dequeue();
+        p1 = comp[comp[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+        p2 = comp[low].load(std::memory_order_relaxed);
+    }
+}
 
-                //  
-                QList<Edge*> edges = getConnectedEdges(current);
-                for (Edge* edge : edges) {
-                    VertexItem* neighbor = (edge->sourceNode() == current) ? edge->destNode() : edge->sourceNode();
+// Сжать пути: каждая вершина отрезка смотрит прямо на корень
+void compress(ComponentArray& comp, int begin, int end)
+{
+    for (int v = begin; v < end; ++v) {
+        int parent = comp[v].load(std::memory_order_relaxed);
+        int grandparent = comp[parent].load(std::memory_order_relaxed);
+        while (parent != grandparent) {
+            comp[v].store(grandparent, std::memory_order_relaxed);
+            parent = grandparent;
+            grandparent = comp[parent].load(std::memory_order_relaxed);
+        }
+    }
+}
 
-                    if (!visited.contains(neighbor)) {
-                        visited.insert(neighbor);
-                        queue.enqueue(neighbor);
+}
 
-                        //        
-                        steps.enqueue({ HighlightEdge, edge, currentColor });
-                        steps.enqueue({ HighlightNode, neighbor, currentColor });
-                    }
-                    //    ,     -    ( )
-                    else {
-                        //  ,      
-                        // (    )
-                        steps.enqueue({ HighlightEdge, edge, currentColor });
-                    }
-                }
+GraphSolver::ComponentsResult GraphSolver::runParallelComponents(bool withTrace) const
+{
+    const int n = m_graph.vertexCount();
+    const int* offsets = m_adjOffsets.data();
+    const int* adjVertex = m_adjVertex.data();
+
+    ComponentArray comp(n);
+    forEachBlock(n, [&comp](int begin, int end) {
+        for (int v = begin; v < end; ++v) comp[v].store(v, std::memory_order_relaxed);
+    });
+
+    std::atomic<qint64> scans{ 0 };
+
+    // 1. Первые соседи: за пару раундов почти все вершины уже в своих деревьях
+    for (int round = 0; round < AfforestNeighborRounds; ++round) {
+        forEachBlock(n, [&, round](int begin, int end) {
+            qint64 blockScans = 0;
+            for (int v = begin; v < end; ++v) {
+                const int k = offsets[v] + round;
+                if (k >= offsets[v + 1]) continue;
+                link(comp, v, adjVertex[k]);
+                blockScans++;
+            }
+            scans += blockScans;
+        });
+        forEachBlock(n, [&comp](int begin, int end) { compress(comp, begin, end); });
+    }
+
+    // 2. Самая частая метка в выборке - (скорее всего) гигантская компонента
+    int giant = -1;
+    if (n > 0) {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        QHash<int, int> frequency;
+        int best = 0;
+        for (int i = 0; i < AfforestSamples; ++i) {
+            const int label = comp[pick(rng)].load(std::memory_order_relaxed);
+            const int count = ++frequency[label];
+            if (count > best) {
+                best = count;
+                giant = label;
             }
         }
     }
 
-    return steps;
+    // 3. Остальные ребра - только у вершин вне гигантской компоненты.
+    // Граф неориентированный: ребро из гигантской компоненты наружу просмотрит внешний конец
+    forEachBlock(n, [&](int begin, int end) {
+        qint64 blockScans = 0;
+        for (int v = begin; v < end; ++v) {
+            if (comp[v].load(std::memory_order_relaxed) == giant) continue;
+            for (int k = offsets[v] + AfforestNeighborRounds; k < offsets[v + 1]; ++k) {
+                link(comp, v, adjVertex[k]);
+                blockScans++;
+            }
+        }
+        scans += blockScans;
+    });
+    forEachBlock(n, [&comp](int begin, int end) { compress(comp, begin, end); });
+
+    // 4. Корень дерева - наименьшая вершина компоненты (подвешиваем всегда под меньший),
+    // поэтому номера по порядку корней совпадают с порядком пошаговой версии
+    ComponentsResult result;
+    result.component.resize(n);
+    std::vector<int> number(n, -1);
+    for (int v = 0; v < n; ++v) {
+        const int root = comp[v].load(std::memory_order_relaxed);
+        if (root == v) number[v] = result.count++;
+        result.component[v] = number[root];
+    }
+
+    result.counters.verticesVisited = n;
+    result.counters.edgeScans = scans;
+    if (withTrace) result.trace = componentTrace(result);
+    return result;
+}
+
+AlgorithmTrace GraphSolver::componentTrace(const ComponentsResult& result) const
+{
+    AlgorithmTrace trace;
+    trace.append({ ResetColors, -1, Qt::white });
+
+    // Вершины и ребра по компонентам (ребро - по компоненте его начала), внутри - по индексу
+    const int n = m_graph.vertexCount();
+    const int edgeCount = m_graph.edgeCount();
+
+    std::vector<int> vertexStart(result.count + 1, 0);
+    std::vector<int> edgeStart(result.count + 1, 0);
+    for (int v = 0; v < n; ++v) vertexStart[result.component[v] + 1]++;
+    for (int e = 0; e < edgeCount; ++e) {
+        if (m_edgeSource[e] >= 0) edgeStart[result.component[m_edgeSource[e]] + 1]++;
+    }
+    for (int c = 0; c < result.count; ++c) {
+        vertexStart[c + 1] += vertexStart[c];
+        edgeStart[c + 1] += edgeStart[c];
+    }
+
+    std::vector<int> vertices(n);
+    std::vector<int> edges(edgeStart.back());
+    std::vector<int> vertexCursor(vertexStart.begin(), vertexStart.end() - 1);
+    std::vector<int> edgeCursor(edgeStart.begin(), edgeStart.end() - 1);
+    for (int v = 0; v < n; ++v) vertices[vertexCursor[result.component[v]]++] = v;
+    for (int e = 0; e < edgeCount; ++e) {
+        if (m_edgeSource[e] >= 0) edges[edgeCursor[result.component[m_edgeSource[e]]]++] = e;
+    }
+
+    // Компонента - сплошной кусок трассы одного цвета: каждая вершина и каждое ребро по разу
+    for (int c = 0; c < result.count; ++c) {
+        const QColor color = ComponentPalette[c % ComponentPaletteSize];
+        for (int i = vertexStart[c]; i < vertexStart[c + 1]; ++i) {
+            trace.append({ HighlightNode, vertices[i], color });
+        }
+        for (int i = edgeStart[c]; i < edgeStart[c + 1]; ++i) {
+            trace.append({ HighlightEdge, edges[i], color });
+        }
+    }
+    return trace;
 }
 
-// ---   DSU ---
-VertexItem* findSet(VertexItem* v, QMap<VertexItem*, VertexItem*>& parent) {
-    if (v == parent[v])
-        return v;
-    return parent[v] = findSet(parent[v], parent);
+// === DELTA-STEPPING (параллельные кратчайшие пути) ===
+// Meyer, Sanders, "Delta-stepping: a parallelizable shortest path algorithm".
+// Вершины лежат в корзинах по расстоянию: корзина i - [i*delta, (i+1)*delta).
+// Корзины разбираются по порядку, но внутри корзины все вершины обрабатываются разом:
+//   легкие ребра (вес <= delta) могут вернуть вершину в ту же корзину - крутим, пока она не опустеет;
+//   тяжелые ребра ведут только в следующие корзины - их релаксируем один раз в конце.
+// Расстояния уменьшаются атомарно (CAS до минимума), поэтому релаксации идут из разных потоков.
+// Дейкстра - это delta-stepping с delta = 1 при целых весах; большая delta - больше параллельной
+// работы, но и больше лишних релаксаций
+namespace {
+
+// Вершин корзины на задачу пула
+const int BucketBlockSize = 256;
+
+// Задача фазы: отрезок списка вершин и что она нарелаксировала
+struct SsspBlock {
+    int begin;
+    int end;
+    std::vector<std::pair<qint64, int>> requests; // (корзина, вершина) с улучшенным расстоянием
+    qint64 scans = 0;
+    qint64 relaxations = 0;
+};
+
+// Уменьшить расстояние до candidate, если оно меньше (true - уменьшили мы)
+bool relaxDistance(std::atomic<qint64>& distance, qint64 candidate)
+{
+    qint64 current = distance.load(std::memory_order_relaxed);
+    while (candidate < current) {
+        if (distance.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) return true;
+    }
+    return false;
 }
 
-void unionSets(VertexItem* a, VertexItem* b, QMap<VertexItem*, VertexItem*>& parent) {
-    a = findSet(a, parent);
-    b = findSet(b, parent);
-    if (a != b)
-        parent[b] = a;
 }
 
-QQueue<AlgorithmStep> GraphSolver::runKruskal()
+GraphSolver::SsspResult GraphSolver::runDeltaStepping(int startNodeId, qint64 delta, bool withTrace) const
 {
-    QQueue<AlgorithmStep> steps;
-    steps.enqueue({ ResetColors, nullptr, Qt::white });
+    const int n = m_graph.vertexCount();
+    const int* offsets = m_adjOffsets.data();
+    const int* adjVertex = m_adjVertex.data();
+    const int* adjEdge = m_adjEdge.data();
+    const GraphEdge* edges = m_graph.edges;
+
+    SsspResult result;
+    result.distance.assign(n, -1);
+    result.parent.assign(n, -1);
+    result.parentEdge.assign(n, -1);
+
+    // Отрицательные веса корзины не выдерживают (вершину пришлось бы переоткрывать) -
+    // такой граф не считаем вовсе, а не выдаем неверные расстояния
+    int maxWeight = 1;
+    for (int e = 0; e < m_graph.edgeCount(); ++e) {
+        if (m_edgeSource[e] < 0) continue;
+        if (edges[e].weight < 0) {
+            result.negativeWeights = true;
+            if (withTrace) result.trace.append({ ResetColors, -1, Qt::white });
+            return result;
+        }
+        maxWeight = qMax(maxWeight, edges[e].weight);
+    }
 
-    // 1.  DSU
-    //    -    ( )
-    QMap<VertexItem*, VertexItem*> parent;
-    for (VertexItem* v : m_vertices) {
-        parent[v] = v;
+    // Ширина корзины по умолчанию: наибольший вес на среднюю степень -
+    // тогда в корзину попадает порядка одного "слоя" соседей
+    if (delta <= 0) {
+        const qint64 averageDegree = n > 0 ? qMax<qint64>(1, qint64(m_adjVertex.size()) / n) : 1;
+        delta = qMax<qint64>(1, maxWeight / averageDegree);
     }
+    result.delta = delta;
 
-    // 2.  
-    //   ,      
-    QList<Edge*> sortedEdges = m_edges;
+    const int start = findNodeById(startNodeId);
+    if (start < 0) {
+        if (withTrace) result.trace.append({ ResetColors, -1, Qt::white });
+        return result;
+    }
 
-    //  -  
-    std::sort(sortedEdges.begin(), sortedEdges.end(), [](Edge* a, Edge* b) {
-        return a->getWeight() < b->getWeight();
+    std::vector<std::atomic<qint64>> distance(n);
+    for (std::atomic<qint64>& d : distance) d.store(InfiniteDistance, std::memory_order_relaxed);
+    distance[start].store(0, std::memory_order_relaxed);
+
+    // Непустые корзины по номеру. Вершина может лежать в нескольких (расстояние уменьшилось) -
+    // устаревшие записи отсеиваются при разборе
+    std::map<qint64, std::vector<int>> buckets;
+    buckets[0].push_back(start);
+
+    // Отметки "уже в списке": вершина попадает в очередной список один раз
+    std::vector<qint64> queuedBucket(n, -1);   // в какой корзине вершина уже стоит в очереди
+    std::vector<qint64> settledBucket(n, -1);  // в какой корзине уже разобрана (для тяжелых ребер)
+    std::vector<int> againStamp(n, 0);         // в каком повторе легкой фазы уже стоит
+    int againRound = 0;
+
+    const qint64 averageDegree = qMax<qint64>(1, qint64(m_adjVertex.size()) / n);
+    std::vector<SsspBlock> blocks;
+
+    // Релаксировать ребра (легкие или тяжелые) вершин list параллельно
+    auto relaxEdges = [&](const std::vector<int>& list, bool light) {
+        splitBlocks(blocks, int(list.size()), BucketBlockSize);
+        runBlocks(blocks, qint64(list.size()) * averageDegree, [&](SsspBlock& block) {
+            for (int i = block.begin; i < block.end; ++i) {
+                const int v = list[i];
+                const qint64 dv = distance[v].load(std::memory_order_relaxed);
+                for (int k = offsets[v]; k < offsets[v + 1]; ++k) {
+                    const int w = edges[adjEdge[k]].weight;
+                    if ((w <= delta) != light) continue;
+
+                    block.scans++;
+                    const int u = adjVertex[k];
+                    const qint64 candidate = addDistance(dv, w);
+                    if (relaxDistance(distance[u], candidate)) {
+                        block.relaxations++;
+                        block.requests.push_back({ candidate / delta, u });
+                    }
+                }
+            }
         });
+    };
 
-    // 3.  
-    int edgesCount = 0; //     ( ,  V-1)
+    while (!buckets.empty()) {
+        const qint64 index = buckets.begin()->first;
+        std::vector<int> current = std::move(buckets.begin()->second);
+        buckets.erase(buckets.begin());
+
+        std::vector<int> settled;  // разобранные в этой корзине - у них потом тяжелые ребра
+
+        // 1. Легкие ребра, пока корзина не опустеет
+        while (!current.empty()) {
+            // Устаревшие записи: расстояние уже уменьшилось в более раннюю корзину
+            std::vector<int> list;
+            list.reserve(current.size());
+            for (int v : current) {
+                if (distance[v].load(std::memory_order_relaxed) / delta != index) continue;
+                list.push_back(v);
+                if (settledBucket[v] != index) {
+                    settledBucket[v] = index;
+                    settled.push_back(v);
+                }
+            }
+            result.counters.verticesVisited += qint64(list.size());
+
+            relaxEdges(list, true);
+
+            // Запросы в эту же корзину - следующий повтор, остальные - в свои корзины
+            current.clear();
+            againRound++;
+            for (SsspBlock& block : blocks) {
+                result.counters.edgeScans += block.scans;
+                result.counters.relaxations += block.relaxations;
+                for (const auto& request : block.requests) {
+                    const int u = request.second;
+                    if (request.first == index) {
+                        if (againStamp[u] != againRound) {
+                            againStamp[u] = againRound;
+                            current.push_back(u);
+                        }
+                    }
+                    else if (queuedBucket[u] != request.first) {
+                        queuedBucket[u] = request.first;
+                        buckets[request.first].push_back(u);
+                    }
+                }
+            }
+        }
+
+        // 2. Тяжелые ребра разобранных вершин - только в следующие корзины
+        relaxEdges(settled, false);
+        for (SsspBlock& block : blocks) {
+            result.counters.edgeScans += block.scans;
+            result.counters.relaxations += block.relaxations;
+            for (const auto& request : block.requests) {
+                if (queuedBucket[request.second] != request.first) {
+                    queuedBucket[request.second] = request.first;
+                    buckets[request.first].push_back(request.second);
+                }
+            }
+        }
+
+        result.buckets++;
+    }
 
-    for (Edge* edge : sortedEdges) {
+    for (int v = 0; v < n; ++v) {
+        const qint64 d = distance[v].load(std::memory_order_relaxed);
+        if (d != InfiniteDistance) result.distance[v] = d;
+    }
 
-        // : "  " ()
-        steps.enqueue({ HighlightEdge, edge, Qt::yellow });
+    // 3. Родители - по готовым расстояниям: первое (в порядке CSR) "тугое" ребро
+    // dist[u] + w == dist[v] с положительным весом. Так дерево не зависит от гонок потоков
+    std::vector<int> plateau;  // вершины, куда кратчайшие пути заходят только ребрами веса 0
+    forEachBlock(n, [&](int begin, int end) {
+        for (int v = begin; v < end; ++v) {
+            if (v == start || result.distance[v] < 0) continue;
+            for (int k = offsets[v]; k < offsets[v + 1]; ++k) {
+                const int u = adjVertex[k];
+                const int w = edges[adjEdge[k]].weight;
+                if (w > 0 && result.distance[u] >= 0 && addDistance(result.distance[u], w) == result.distance[v]) {
+                    result.parent[v] = u;
+                    result.parentEdge[v] = adjEdge[k];
+                    break;
+                }
+            }
+        }
+    });
+    for (int v = 0; v < n; ++v) {
+        if (v != start && result.distance[v] >= 0 && result.parent[v] < 0) plateau.push_back(v);
+    }
 
-        VertexItem* u = edge->sourceNode();
-        VertexItem* v = edge->destNode();
+    // Нулевые ребра (редкость) могли бы замкнуть родителей в цикл - такие вершины
+    // подвешиваем по очереди только к уже подвешенным
+    for (bool progress = true; progress && !plateau.empty();) {
+        progress = false;
+        std::vector<int> rest;
+        for (int v : plateau) {
+            bool attached = false;
+            for (int k = offsets[v]; k < offsets[v + 1] && !attached; ++k) {
+                const int u = adjVertex[k];
+                if (edges[adjEdge[k]].weight != 0 || result.distance[u] != result.distance[v]) continue;
+                if (u != start && result.parent[u] < 0) continue;
+                result.parent[v] = u;
+                result.parentEdge[v] = adjEdge[k];
+                attached = true;
+            }
+            if (attached) progress = true;
+            else rest.push_back(v);
+        }
+        plateau.swap(rest);
+    }
 
-        // ,     
-        if (findSet(u, parent) != findSet(v, parent)) {
-            //    ->  !
-            unionSets(u, v, parent);
+    if (withTrace) result.trace = bucketTrace(result, start);
+    return result;
+}
 
-            // : "!" ()
-            steps.enqueue({ HighlightEdge, edge, Qt::green });
-            //   ,   ,     
-            steps.enqueue({ HighlightNode, u, Qt::green });
-            steps.enqueue({ HighlightNode, v, Qt::green });
+AlgorithmTrace GraphSolver::bucketTrace(const SsspResult& result, int start) const
+{
+    AlgorithmTrace trace;
+    trace.append({ ResetColors, -1, Qt::white });
 
-            edgesCount++;
+    // Достигнутые вершины по (корзина, расстояние, индекс)
+    std::vector<int> order;
+    for (int v = 0; v < int(result.distance.size()); ++v) {
+        if (result.distance[v] >= 0) order.push_back(v);
+    }
+    std::sort(order.begin(), order.end(), [&result](int a, int b) {
+        if (result.distance[a] != result.distance[b]) return result.distance[a] < result.distance[b];
+        return a < b;
+    });
+
+    // Корзина целиком: ее вершины "в работе" (оранжевым, как улучшенные у Дейкстры),
+    // потом закреплены (зеленым) вместе с ребрами дерева
+    for (size_t first = 0; first < order.size();) {
+        const qint64 bucket = result.distance[order[first]] / result.delta;
+        size_t last = first;
+        while (last < order.size() && result.distance[order[last]] / result.delta == bucket) last++;
+
+        for (size_t i = first; i < last; ++i) {
+            if (order[i] != start) trace.append({ HighlightNode, order[i], Qt::darkYellow });
         }
-        else {
-            //    ->  , 
-            // : " !" (  )
-            steps.enqueue({ HighlightEdge, edge, Qt::red }); //  : ", !"
+        for (size_t i = first; i < last; ++i) {
+            const int v = order[i];
+            if (result.parentEdge[v] >= 0) trace.append({ HighlightEdge, result.parentEdge[v], Qt::green });
+            trace.append({ HighlightNode, v, Qt::green });
         }
+        first = last;
     }
+    return trace;
+}
 
-    return steps;
+std::unique_ptr<StepGenerator> GraphSolver::makeBFS(int startNodeId) const
+{
+    return std::make_unique<BfsGenerator>(*this, startNodeId);
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeDFS(int startNodeId) const
+{
+    return std::make_unique<DfsGenerator>(*this, startNodeId);
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeDijkstra(int startNodeId) const
+{
+    return std::make_unique<DijkstraGenerator>(*this, startNodeId);
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeConnectedComponents() const
+{
+    return std::make_unique<ComponentsGenerator>(*this);
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeKruskal() const
+{
+    return std::make_unique<KruskalGenerator>(*this);
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeParallelBFS(int startNodeId) const
+{
+    return std::make_unique<PrecomputedGenerator>([this, startNodeId](SolverCounters& counters) {
+        BfsResult result = runParallelBFS(startNodeId, true);
+        counters = result.counters;
+        return std::move(result.trace);
+    });
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeParallelComponents() const
+{
+    return std::make_unique<PrecomputedGenerator>([this](SolverCounters& counters) {
+        ComponentsResult result = runParallelComponents(true);
+        counters = result.counters;
+        return std::move(result.trace);
+    });
+}
+
+std::unique_ptr<StepGenerator> GraphSolver::makeDeltaStepping(int startNodeId, qint64 delta) const
+{
+    return std::make_unique<PrecomputedGenerator>([this, startNodeId, delta](SolverCounters& counters) {
+        SsspResult result = runDeltaStepping(startNodeId, delta, true);
+        counters = result.counters;
+        return std::move(result.trace);
+    });
+}
+
+AlgorithmTrace GraphSolver::runBFS(int startNodeId)
+{
+    return collect(*makeBFS(startNodeId));
+}
+
+AlgorithmTrace GraphSolver::runDFS(int startNodeId)
+{
+    return collect(*makeDFS(startNodeId));
+}
+
+AlgorithmTrace GraphSolver::runDijkstra(int startNodeId)
+{
+    return collect(*makeDijkstra(startNodeId));
+}
+
+AlgorithmTrace GraphSolver::runConnectedComponents()
+{
+    return collect(*makeConnectedComponents());
+}
+
+AlgorithmTrace GraphSolver::runKruskal()
+{
+    return collect(*makeKruskal());
 }
\ No newline at end of file
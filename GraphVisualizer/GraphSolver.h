@@ -1,53 +1,132 @@
 #pragma once
 
-#include <QObject>
-#include <QList>
 #include <QColor>
-#include <QQueue>
-#include <QMap>
-
-//  ,  Solver ,   
-class VertexItem;
-class Edge;
-
-//  ,     
-enum StepType {
-    HighlightNode, //  
-    HighlightEdge, //  
-    ResetColors    //   ( )
-};
-
-//    
-struct AlgorithmStep {
-    StepType type;
-    void* item;    //    (VertexItem*  Edge*)
-    QColor color;  //    
-};
+#include <memory>
+#include <vector>
+
+#include "GraphStore.h"
+#include "AlgorithmTrace.h"
+#include "StepGenerator.h"
 
 class GraphSolver
 {
 public:
     GraphSolver();
 
-    //    "" (    )
-    void setGraphData(QList<VertexItem*> vertices, QList<Edge*> edges);
+    // Решатель может ссылаться на собственную копию графа - копировать его нельзя
+    GraphSolver(const GraphSolver&) = delete;
+    GraphSolver& operator=(const GraphSolver&) = delete;
+
+    // Загрузка графа в "мозг". Сцена для этого не нужна:
+    // GUI собирает GraphStore из своих элементов, пакетный режим - откуда угодно
+    void setGraphData(GraphStore graph);
+
+    // То же без копирования: решатель читает чужую память (например, отображенный
+    // GraphFile), которая должна жить, пока решатель и его генераторы ею пользуются
+    void setGraphView(GraphSpan graph);
+
+    GraphSpan graph() const { return m_graph; }
+
+    // --- Алгоритмы ---
+    // Ленивые версии: генератор выдает шаги по одному по мере запроса.
+    // Генератор читает граф решателя, поэтому решатель должен жить дольше генератора
+    // и не получать новый граф, пока генератор используется
+    std::unique_ptr<StepGenerator> makeBFS(int startNodeId) const;
+    std::unique_ptr<StepGenerator> makeDFS(int startNodeId) const;
+    std::unique_ptr<StepGenerator> makeDijkstra(int startNodeId) const;
+    std::unique_ptr<StepGenerator> makeConnectedComponents() const;
+    std::unique_ptr<StepGenerator> makeKruskal() const;
+
+    // Полные версии: прогоняют генератор до конца и возвращают всю трассу
+    AlgorithmTrace runBFS(int startNodeId);
+    AlgorithmTrace runDFS(int startNodeId);
+    AlgorithmTrace runDijkstra(int startNodeId);
+    AlgorithmTrace runConnectedComponents();
+    AlgorithmTrace runKruskal();
+
+    // Выбрать из генератора все оставшиеся шаги
+    static AlgorithmTrace collect(StepGenerator& generator);
 
-    // ---  ---
-    //    ,   
-    QQueue<AlgorithmStep> runBFS(int startNodeId);
-    QQueue<AlgorithmStep> runDFS(int startNodeId);
-    QQueue<AlgorithmStep> runDijkstra(int startNodeId);
-    QQueue<AlgorithmStep> runConnectedComponents();
-    QQueue<AlgorithmStep> runKruskal();
+    // --- Аналитика без анимации ---
+    // BFS по уровням для больших графов: фронт целиком, направление обхода выбирается
+    // на каждом уровне (сверху вниз / снизу вверх), уровень считается в пуле потоков.
+    // Шаги по ходу не пишутся; по желанию трасса строится в конце - по уровням
+    struct BfsResult {
+        std::vector<int> level;       // расстояние от старта в ребрах, -1 - не достигнута
+        std::vector<int> parent;      // вершина-родитель в дереве обхода (-1 у старта и недостигнутых)
+        std::vector<int> parentEdge;  // ребро к родителю
+        int depth = 0;                // наибольший уровень
+        int bottomUpLevels = 0;       // сколько уровней пройдено снизу вверх
+        SolverCounters counters;
+        AlgorithmTrace trace;         // пустая, если withTrace = false
+    };
+    BfsResult runParallelBFS(int startNodeId, bool withTrace = false) const;
+
+    // То же для проигрывания: генератор отдает трассу по уровням
+    std::unique_ptr<StepGenerator> makeParallelBFS(int startNodeId) const;
+
+    // Компоненты связности в пуле потоков (Afforest: выборка соседей + подвешивание без блокировок).
+    // Номера компонент - по наименьшей вершине, как их находит пошаговая версия, цвета те же
+    struct ComponentsResult {
+        std::vector<int> component;   // номер компоненты для каждой вершины
+        int count = 0;
+        SolverCounters counters;
+        AlgorithmTrace trace;         // по компоненте за раз: ее вершины и ребра ее цветом
+    };
+    ComponentsResult runParallelComponents(bool withTrace = false) const;
+    std::unique_ptr<StepGenerator> makeParallelComponents() const;
+
+    // Кратчайшие пути delta-stepping: корзины по расстоянию шириной delta, вершины корзины
+    // релаксируются в пуле потоков (легкие ребра - до опустения корзины, тяжелые - один раз).
+    // Расстояния те же, что у Дейкстры. delta <= 0 - подобрать по весам и средней степени.
+    // При ребре с отрицательным весом ничего не считается: результат пуст, negativeWeights = true
+    struct SsspResult {
+        std::vector<qint64> distance; // -1 - не достигнута
+        std::vector<int> parent;      // вершина-родитель в дереве кратчайших путей
+        std::vector<int> parentEdge;
+        qint64 delta = 0;             // ширина корзины, с которой считали
+        int buckets = 0;              // сколько корзин разобрано
+        bool negativeWeights = false; // отказались считать: есть ребро с весом < 0
+        SolverCounters counters;
+        AlgorithmTrace trace;         // по корзинам: вершины корзины, потом они же закрепленными
+    };
+    SsspResult runDeltaStepping(int startNodeId, qint64 delta = 0, bool withTrace = false) const;
+    std::unique_ptr<StepGenerator> makeDeltaStepping(int startNodeId, qint64 delta = 0) const;
 
 private:
-    //     
-    QList<VertexItem*> m_vertices;
-    QList<Edge*> m_edges;
+    // Машины состояний алгоритмов (GraphSolver.cpp)
+    class BfsGenerator;
+    class DfsGenerator;
+    class DijkstraGenerator;
+    class ComponentsGenerator;
+    class KruskalGenerator;
+    class PrecomputedGenerator;
+
+    // Трасса BFS по уровням: фронт уровня - желтым вместе с ребрами дерева, разобранный - серым
+    AlgorithmTrace levelTrace(const BfsResult& result, int start) const;
+    // Трасса компонент: каждая - сплошным куском одного цвета
+    AlgorithmTrace componentTrace(const ComponentsResult& result) const;
+    // Трасса delta-stepping по корзинам
+    AlgorithmTrace bucketTrace(const SsspResult& result, int start) const;
+
+    // Сам граф: плоские массивы вершин и ребер.
+    // m_graph смотрит либо в m_ownedGraph, либо в чужую память (setGraphView)
+    GraphStore m_ownedGraph;
+    GraphSpan m_graph;
+
+    // Компактная смежность (CSR), строится один раз в setGraphData.
+    // Соседи вершины i лежат в m_adjVertex/m_adjEdge на отрезке
+    // [m_adjOffsets[i], m_adjOffsets[i + 1]) в том же порядке, что и ребра в m_graph
+    std::vector<int> m_adjOffsets;
+    std::vector<int> m_adjVertex;         // индекс соседа
+    std::vector<int> m_adjEdge;           // индекс ребра
+
+    // Концы ребер после проверки (-1, если индекс вне графа)
+    std::vector<int> m_edgeSource;
+    std::vector<int> m_edgeTarget;
 
-    //  :    ID
-    VertexItem* findNodeById(int id);
+    void buildAdjacency();
 
-    //  :  ,   
-    QList<Edge*> getConnectedEdges(VertexItem* node);
+    // Вспомогательный метод: найти индекс вершины по ID (-1, если нет)
+    int findNodeById(int id) const;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+﻿#include "GraphStore.h"
+
+int GraphStore::addVertex(int id, float x, float y)
+{
+    vertices.push_back({ id, x, y });
+    return int(vertices.size()) - 1;
+}
+
+int GraphStore::addEdge(int source, int target, int weight)
+{
+    edges.push_back({ source, target, weight });
+    return int(edges.size()) - 1;
+}
+
+void GraphStore::reserve(int vertexCount, int edgeCount)
+{
+    vertices.reserve(vertexCount);
+    edges.reserve(edgeCount);
+}
+
+void GraphStore::clear()
+{
+    vertices.clear();
+    edges.clear();
+}
+
+int GraphStore::indexOfId(int id) const
+{
+    return view().indexOfId(id);
+}
+
+GraphSpan GraphStore::view() const
+{
+    return { vertices.data(), edges.data(), int(vertices.size()), int(edges.size()) };
+}
+
+int GraphSpan::indexOfId(int id) const
+{
+    for (int i = 0; i < numVertices; ++i) {
+        if (vertices[i].id == id) return i;
+    }
+    return -1;
+}
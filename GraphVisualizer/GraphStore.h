@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+// Вершина без графики: ID, который видит пользователь, и (необязательные) координаты
+struct GraphVertex {
+    qint32 id;
+    float x;
+    float y;
+};
+
+// Ребро без графики: концы - индексы в GraphStore::vertices
+struct GraphEdge {
+    qint32 source;
+    qint32 target;
+    qint32 weight;
+};
+
+// Граф только для чтения поверх чужой памяти: массивов GraphStore или отображенного файла.
+// Ничем не владеет, поэтому память должна жить дольше вида
+struct GraphSpan
+{
+    const GraphVertex* vertices = nullptr;
+    const GraphEdge* edges = nullptr;
+    int numVertices = 0;
+    int numEdges = 0;
+
+    int vertexCount() const { return numVertices; }
+    int edgeCount() const { return numEdges; }
+    bool isEmpty() const { return numVertices == 0; }
+
+    // Индекс вершины по ее ID (-1, если такой нет). Линейный поиск
+    int indexOfId(int id) const;
+};
+
+// Хранилище графа без QGraphicsItem: два плоских массива POD-записей.
+// Решатель работает только с ним, поэтому граф можно обработать без сцены,
+// а GUI лишь сопоставляет индексы вершин/ребер своим элементам
+struct GraphStore
+{
+    std::vector<GraphVertex> vertices;
+    std::vector<GraphEdge> edges;
+
+    int vertexCount() const { return int(vertices.size()); }
+    int edgeCount() const { return int(edges.size()); }
+    bool isEmpty() const { return vertices.empty(); }
+
+    // Добавить вершину/ребро, возвращает индекс новой записи
+    int addVertex(int id, float x = 0, float y = 0);
+    int addEdge(int source, int target, int weight = 1);
+
+    void reserve(int vertexCount, int edgeCount);
+    void clear();
+
+    // Индекс вершины по ее ID (-1, если такой нет). Линейный поиск
+    int indexOfId(int id) const;
+
+    // Вид на массивы хранилища (действителен до их изменения)
+    GraphSpan view() const;
+};
@@ -4,6 +4,19 @@
 #include <QToolBar>
 #include <QMenu>
 #include <QAction>  
+#include <QHash>
+#include <QtConcurrent/QtConcurrent>
+#include <QSignalBlocker>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QtMath>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QApplication>
+#include <QStatusBar>
+#include <QInputDialog>
 
 #include "Edge.h"
 
@@ -14,10 +27,88 @@ GraphVisualizer::GraphVisualizer(QWidget *parent)
 
     setupScene();
     setupUiCustom();
+
+    m_solverWatcher = new QFutureWatcher<void>(this);
+    connect(m_solverWatcher, &QFutureWatcher<void>::progressValueChanged, m_progressBar, &QProgressBar::setValue);
+    connect(m_solverWatcher, &QFutureWatcher<void>::finished, this, &GraphVisualizer::onSolverFinished);
+    m_solverFutures.setCancelOnWait(true);
+
+    // Сигнал испускается из рабочего потока - явно через очередь
+    connect(this, &GraphVisualizer::stepsReady, this, &GraphVisualizer::onStepsReady, Qt::QueuedConnection);
+    connect(this, &GraphVisualizer::solverMeasured, this, &GraphVisualizer::onSolverMeasured, Qt::QueuedConnection);
+
+    m_importWatcher = new QFutureWatcher<ImportResult>(this);
+    connect(m_importWatcher, &QFutureWatcher<ImportResult>::progressValueChanged, m_progressBar, &QProgressBar::setValue);
+    connect(m_importWatcher, &QFutureWatcher<ImportResult>::finished, this, &GraphVisualizer::onImportFinished);
+
+    m_layoutWatcher = new QFutureWatcher<void>(this);
+    m_layoutFutures.setCancelOnWait(true);
+    connect(this, &GraphVisualizer::layoutReady, this, &GraphVisualizer::onLayoutReady, Qt::QueuedConnection);
 }
 
 GraphVisualizer::~GraphVisualizer()
-{}
+{
+    // Рабочие потоки испускают наши сигналы - дожидаемся их до разрушения окна.
+    // Ждем все прогоны, а не только последний: прерванный может еще досчитывать
+    m_solverFutures.waitForFinished();
+    m_layoutFutures.waitForFinished();
+    m_importWatcher->cancel();
+    m_importWatcher->waitForFinished();
+
+    // В режиме слоя ребра не принадлежат сцене - удаляем их сами, пока слой жив
+    if (m_edgeLayer) qDeleteAll(m_edgeItems);
+}
+
+// Масштаб вида: шаг колеса и пределы
+static const qreal ZoomStep = 1.2;
+static const qreal MinZoom = 0.01;
+static const qreal MaxZoom = 10.0;
+
+// Шкала индикатора прогресса
+static const int ProgressScale = 1000;
+
+// Запомнить задачу в синхронизаторе. Отмена не останавливает задачу сразу (а готовые
+// алгоритмы не проверяют ее вовсе), поэтому ждать надо всех, кто еще работает;
+// закончившиеся при этом забываем, чтобы список не рос весь сеанс
+static void trackFuture(QFutureSynchronizer<void>& synchronizer, const QFuture<void>& future)
+{
+    const QList<QFuture<void>> futures = synchronizer.futures();
+    synchronizer.clearFutures();
+    for (const QFuture<void>& f : futures) {
+        if (!f.isFinished()) synchronizer.addFuture(f);
+    }
+    synchronizer.addFuture(future);
+}
+// Первая порция маленькая, чтобы показ начался сразу; дальше - блоками трассы
+static const qsizetype FirstBatchSize = 256;
+static const qsizetype BatchSize = 65536;
+// Как часто (в шагах) рабочий поток проверяет отмену и обновляет прогресс
+static const qsizetype ProgressInterval = 4096;
+
+// Автоплей тикает раз в кадр (~60 Гц)
+static const int FrameInterval = 16;
+// Режим "без ограничения": сколько времени кадра отдаем шагам и какими пачками проверяем время
+static const qint64 FrameBudgetMs = 10;
+static const qsizetype FastBatchSize = 4096;
+// Скорости автоплея для ползунка, шагов в секунду (0 - без ограничения)
+static const int SpeedSteps[] = { 1, 3, 10, 30, 100, 300, 1000, 3000, 10000, 100000, 0 };
+static const int SpeedCount = int(sizeof(SpeedSteps) / sizeof(SpeedSteps[0]));
+static const int DefaultSpeed = 1; // 3 шага в секунду - как старые 300 мс на шаг
+
+// Кадр раскладки не чаще ~30 раз в секунду: между кадрами рабочий поток просто считает итерации
+static const int LayoutFrameInterval = 33;
+
+// С какого числа ребер открытый из файла граф сразу рисуется слоем ребер
+static const int LargeGraphEdges = 20000;
+
+// Пакет меньше этого (добавленных и сдвинутых элементов) индекс сцены не снимает
+static const qsizetype BatchIndexThreshold = 4096;
+static const char GraphFileFilter[] = "Граф (*.gvg)";
+static const char ImportFilter[] = "Списки ребер (*.txt *.el *.edges *.tsv *.csv *.gr *.mtx);;Все файлы (*)";
+static const char MetricsFilter[] = "JSON (*.json)";
+
+// Строка метрик во время автоплея обновляется не чаще раза в 250 мс
+static const int MetricsLabelInterval = 250;
 
 
 void GraphVisualizer::setupScene()
@@ -27,6 +118,11 @@ void GraphVisualizer::setupScene()
     view = new QGraphicsView(scene);
     view->setRenderHint(QPainter::Antialiasing);
 
+    // Масштаб колесом (к точке под курсором) и панорама средней кнопкой.
+    // На мелком масштабе элементы сами рисуются упрощенно (LevelOfDetail.h)
+    view->setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    view->viewport()->installEventFilter(this);
+
     setCentralWidget(view);
 
     scene->setSceneRect(0, 0, 800, 600);
@@ -37,12 +133,16 @@ void GraphVisualizer::setupScene()
 
     // Создаем таймер
     autoPlayTimer = new QTimer(this);
-    // Говорим таймеру: "Когда тикнешь, вызови onNextStep"
-    connect(autoPlayTimer, &QTimer::timeout, this, &GraphVisualizer::onNextStep);
+    // Говорим таймеру: "Когда тикнешь, покажи следующий кадр"
+    connect(autoPlayTimer, &QTimer::timeout, this, &GraphVisualizer::onFrame);
 }
 
 bool GraphVisualizer::eventFilter(QObject* watched, QEvent* event)
 {
+    if (watched == view->viewport() && handleViewNavigation(event)) {
+        return true;
+    }
+
     if (watched == scene && event->type() == QEvent::GraphicsSceneMousePress)
     {
         QGraphicsSceneMouseEvent* mouseEvent = static_cast<QGraphicsSceneMouseEvent*>(event);
@@ -67,16 +167,8 @@ bool GraphVisualizer::eventFilter(QObject* watched, QEvent* event)
                     }
                     else {
                         // Это второй клик (конец ребра)
-                        // Проверка: нельзя соединить вершину саму с собой и нельзя создавать дубликаты
-                        if (firstVertex != clickedVertex) {
-                            bool edgeExists = false;
-                            if (!firstVertex->isConnectedTo(clickedVertex)) {
-                                Edge* newEdge = new Edge(firstVertex, clickedVertex);
-                                scene->addItem(newEdge);
-                                firstVertex->addEdge(newEdge);
-                                clickedVertex->addEdge(newEdge);
-                            }
-                        }
+                        // addEdge сам отказывается от петли и дубликата (проверка по хэшу концов)
+                        addEdge(firstVertex, clickedVertex);
 
                         // Сбрасываем состояние
                         firstVertex->setColor(Qt::white); // Возвращаем цвет
@@ -93,9 +185,8 @@ bool GraphVisualizer::eventFilter(QObject* watched, QEvent* event)
                     firstVertex = nullptr;
                 }
                 else {
-                    // Иначе создаем новую вершину (старый код)
-                    VertexItem* ver = new VertexItem(nextId++, position);
-                    scene->addItem(ver);
+                    // Иначе создаем новую вершину
+                    addVertex(position);
                 }
                 return true;
             }
@@ -104,16 +195,155 @@ bool GraphVisualizer::eventFilter(QObject* watched, QEvent* event)
     return QMainWindow::eventFilter(watched, event);
 }
 
+bool GraphVisualizer::handleViewNavigation(QEvent* event)
+{
+    if (event->type() == QEvent::Wheel) {
+        QWheelEvent* wheelEvent = static_cast<QWheelEvent*>(event);
+
+        // Один щелчок колеса (120) - примерно 20% масштаба
+        qreal factor = qPow(ZoomStep, wheelEvent->angleDelta().y() / 120.0);
+
+        // Не даем улететь в бесконечно мелкий или крупный масштаб
+        const qreal current = view->transform().m11();
+        factor = qBound(MinZoom / current, factor, MaxZoom / current);
+
+        view->scale(factor, factor);
+        return true;
+    }
+
+    if (event->type() == QEvent::MouseButtonPress) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+        if (mouseEvent->button() == Qt::MiddleButton) {
+            m_panning = true;
+            m_panStart = mouseEvent->pos();
+            view->viewport()->setCursor(Qt::ClosedHandCursor);
+            return true;
+        }
+    }
+    else if (event->type() == QEvent::MouseMove && m_panning) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+        const QPoint delta = mouseEvent->pos() - m_panStart;
+        m_panStart = mouseEvent->pos();
+
+        view->horizontalScrollBar()->setValue(view->horizontalScrollBar()->value() - delta.x());
+        view->verticalScrollBar()->setValue(view->verticalScrollBar()->value() - delta.y());
+        return true;
+    }
+    else if (event->type() == QEvent::MouseButtonRelease && m_panning) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+        if (mouseEvent->button() == Qt::MiddleButton) {
+            m_panning = false;
+            view->viewport()->unsetCursor();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Добавить элемент в конец реестра
+template<class T>
+static void registerItem(QList<T*>& items, QHash<T*, int>& index, T* item)
+{
+    index.insert(item, int(items.size()));
+    items.append(item);
+}
+
+// Убрать элемент из реестра за O(1): на его место встает последний
+template<class T>
+static void unregisterItem(QList<T*>& items, QHash<T*, int>& index, T* item)
+{
+    const int position = index.value(item, -1);
+    if (position < 0) return;
+    index.remove(item);
+
+    T* last = items.takeLast();
+    if (last != item) {
+        items[position] = last;
+        index[last] = position;
+    }
+}
+
+void GraphVisualizer::registerVertex(VertexItem* v)
+{
+    registerItem(m_vertexItems, m_vertexIndex, v);
+}
+
+void GraphVisualizer::registerEdge(Edge* e)
+{
+    m_edgeItems.append(e);
+
+    // Хэши еще не построены - ребро попадет в них вместе с остальными
+    if (!m_edgeIndexPending) indexEdge(e, int(m_edgeItems.size()) - 1);
+}
+
+void GraphVisualizer::indexEdge(Edge* e, int position) const
+{
+    m_edgeIndex.insert(e, position);
+
+    // Повторное ребро (бывает только из файла) в хэш не попадает - там уже первое.
+    // Один поиск в хэше вместо contains + insert: при открытии файла это миллионы ребер
+    Edge*& first = m_edgeByEnds[edgeEnds(e->sourceNode(), e->destNode())];
+    if (!first) first = e;
+}
+
+void GraphVisualizer::ensureEdgeIndex() const
+{
+    if (!m_edgeIndexPending) return;
+    m_edgeIndexPending = false;
+
+    m_edgeIndex.reserve(m_edgeItems.size());
+    m_edgeByEnds.reserve(m_edgeItems.size());
+    for (int i = 0; i < int(m_edgeItems.size()); ++i) {
+        indexEdge(m_edgeItems[i], i);
+    }
+}
+
+void GraphVisualizer::unregisterVertex(VertexItem* v)
+{
+    unregisterItem(m_vertexItems, m_vertexIndex, v);
+}
+
+void GraphVisualizer::unregisterEdge(Edge* e)
+{
+    ensureEdgeIndex();
+    unregisterItem(m_edgeItems, m_edgeIndex, e);
+
+    const EdgeEnds ends = edgeEnds(e->sourceNode(), e->destNode());
+    if (m_edgeByEnds.value(ends, nullptr) != e) return;
+    m_edgeByEnds.remove(ends);
+
+    // Если между этими вершинами было еще ребро - теперь хэш указывает на него
+    for (Edge* other : e->sourceNode()->getEdges()) {
+        if (other != e && edgeEnds(other->sourceNode(), other->destNode()) == ends) {
+            m_edgeByEnds.insert(ends, other);
+            break;
+        }
+    }
+}
+
 void GraphVisualizer::removeEdge(Edge* e)
 {
     if (!e) return;
 
+    // Шаги алгоритма и кадры раскладки ссылаются на индексы старого графа - после правки они недействительны
+    stopPlayback();
+    stopLayout();
+
+    destroyEdge(e, nullptr);
+}
+
+void GraphVisualizer::destroyEdge(Edge* e, VertexItem* dying)
+{
     // 1. Сообщаем вершинам, что этого ребра больше нет
-    if (e->sourceNode()) e->sourceNode()->removeEdgeFromList(e);
-    if (e->destNode()) e->destNode()->removeEdgeFromList(e);
+    if (e->sourceNode() && e->sourceNode() != dying) e->sourceNode()->removeEdgeFromList(e);
+    if (e->destNode() && e->destNode() != dying) e->destNode()->removeEdgeFromList(e);
 
-    // 2. Удаляем визуально со сцены
-    scene->removeItem(e);
+    // 2. Удаляем визуально со сцены и из реестра
+    // (в режиме слоя ребра в сцене нет - ячейку в слое освободит деструктор)
+    if (e->scene()) scene->removeItem(e);
+    unregisterEdge(e);
+    m_batchDirtyEdges.remove(e);
 
     // 3. Удаляем из памяти
     delete e;
@@ -123,59 +353,519 @@ void GraphVisualizer::removeVertex(VertexItem* v)
 {
     if (!v) return;
 
-    // 1. Сначала удаляем ВСЕ ребра, связанные с этой вершиной
-    // Делаем копию списка, так как будем удалять из оригинала в процессе
-    QList<Edge*> edgesToRemove = v->getEdges();
+    stopPlayback();
+    stopLayout();
+
+    destroyVertex(v);
+}
+
+void GraphVisualizer::destroyVertex(VertexItem* v)
+{
+    // 1. Сначала удаляем ВСЕ ребра, связанные с этой вершиной.
+    // Список вершины забираем целиком: вычеркивать ребра из него по одному
+    // (removeOne) на вершине-хабе стоило бы O(deg^2)
+    QList<Edge*> edgesToRemove;
+    edgesToRemove.swap(v->getEdges());
 
     for (Edge* edge : edgesToRemove) {
-        removeEdge(edge);
+        destroyEdge(edge, v);
     }
 
-    // 2. Удаляем саму вершину со сцены
+    if (firstVertex == v) firstVertex = nullptr;
+
+    // 2. Удаляем саму вершину со сцены и из реестра
     scene->removeItem(v);
+    unregisterVertex(v);
 
     // 3. Удаляем из памяти
     delete v;
 }
 
-void GraphVisualizer::executeStep()
+VertexItem* GraphVisualizer::addVertex(QPointF position)
 {
-    if (currentSteps.isEmpty()) {
-        actNextStep->setEnabled(false); // Если шаги кончились, гасим кнопку
-        actAutoPlay->setEnabled(false);
+    return addVertex(nextId, position);
+}
+
+VertexItem* GraphVisualizer::addVertex(int id, QPointF position)
+{
+    VertexItem* v = new VertexItem(id, position);
+    scene->addItem(v);
+    registerVertex(v);
+
+    // Счетчик не должен выдать уже занятый ID
+    nextId = qMax(nextId, id + 1);
+    return v;
+}
+
+Edge* GraphVisualizer::addEdge(VertexItem* a, VertexItem* b, int weight)
+{
+    // Нельзя соединить вершину саму с собой и нельзя создавать дубликаты
+    if (!a || !b || a == b || findEdge(a, b)) return nullptr;
+    return createEdge(a, b, weight);
+}
+
+Edge* GraphVisualizer::createEdge(VertexItem* a, VertexItem* b, int weight)
+{
+    Edge* e = new Edge(a, b);
+    e->setWeight(weight);
+
+    // Геометрию ребро считает, пока оно еще не в сцене - без обновления индекса
+    a->addEdge(e);
+    if (b != a) b->addEdge(e);
 
-        // Останавливаем таймер, если он работал
-        if (autoPlayTimer->isActive()) {
-            autoPlayTimer->stop();
-            actAutoPlay->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+    if (m_edgeLayer) e->attachToLayer(m_edgeLayer);
+    else scene->addItem(e);
+    registerEdge(e);
+    return e;
+}
+
+void GraphVisualizer::createLayerEdges(const GraphSpan& graph)
+{
+    const int edgeCount = graph.edgeCount();
+    if (edgeCount == 0) return;
+
+    // Линии берем прямо из координат файла (вершины стоят там же), заодно считаем степени
+    std::vector<QLineF> lines;
+    lines.reserve(edgeCount);
+    std::vector<int> degree(graph.vertexCount(), 0);
+    for (int i = 0; i < edgeCount; ++i) {
+        const GraphEdge& ge = graph.edges[i];
+        const GraphVertex& a = graph.vertices[ge.source];
+        const GraphVertex& b = graph.vertices[ge.target];
+        lines.emplace_back(a.x, a.y, b.x, b.y);
+
+        degree[ge.source]++;
+        if (ge.target != ge.source) degree[ge.target]++;
+    }
+    for (int v = 0; v < graph.vertexCount(); ++v) {
+        m_vertexItems[v]->getEdges().reserve(m_vertexItems[v]->getEdges().size() + degree[v]);
+    }
+
+    // Слой - одной пачкой; новое ребро черное, как его рисует Edge
+    const int firstSlot = m_edgeLayer->addEdges(lines.data(), edgeCount, QColor(Qt::black));
+
+    // Edge остаются данными реестра (трасса красит их по индексу), но в сцену не идут:
+    // ни addItem, ни пересчета геометрии через вершину, ни хэшей на каждое ребро
+    const int firstPosition = int(m_edgeItems.size());
+    m_edgeIndexPending = true;
+    m_edgeItems.reserve(firstPosition + edgeCount);
+    for (int i = 0; i < edgeCount; ++i) {
+        const GraphEdge& ge = graph.edges[i];
+        VertexItem* a = m_vertexItems[ge.source];
+        VertexItem* b = m_vertexItems[ge.target];
+
+        Edge* e = new Edge(a, b);
+        e->setWeight(ge.weight);
+        e->attachToLayer(m_edgeLayer, firstSlot + i);
+
+        a->getEdges().append(e);
+        if (b != a) b->getEdges().append(e);
+        m_edgeItems.append(e);
+    }
+}
+
+GraphVisualizer::EdgeEnds GraphVisualizer::edgeEnds(VertexItem* a, VertexItem* b)
+{
+    return std::less<VertexItem*>()(a, b) ? EdgeEnds(a, b) : EdgeEnds(b, a);
+}
+
+Edge* GraphVisualizer::findEdge(VertexItem* a, VertexItem* b) const
+{
+    ensureEdgeIndex();
+    return m_edgeByEnds.value(edgeEnds(a, b), nullptr);
+}
+
+void GraphVisualizer::moveVertex(VertexItem* v, QPointF position)
+{
+    if (m_batchDepth == 0) {
+        v->setPos(position);
+        return;
+    }
+
+    // В пакете ребра подтянем один раз при commitBatch()
+    v->setPosBatched(position);
+    for (Edge* e : v->getEdges()) {
+        m_batchDirtyEdges.insert(e);
+    }
+}
+
+void GraphVisualizer::beginBatch(qsizetype itemCount)
+{
+    if (m_batchDepth++ > 0) return;
+
+    // Без индекса добавление и сдвиг элемента не перестраивают BSP-дерево сцены,
+    // но смена режима сама перекладывает все элементы сцены (O(N log N)).
+    // Поэтому индекс снимаем только для пакета, сравнимого со всей сценой;
+    // удалению он не нужен вовсе - без индекса оно линейное
+    const qsizetype sceneItems = m_vertexItems.size() + (m_edgeLayer ? 0 : m_edgeItems.size());
+    m_batchIndexMethod = scene->itemIndexMethod();
+    m_batchUnindexed = m_batchIndexMethod != QGraphicsScene::NoIndex
+        && itemCount >= BatchIndexThreshold && itemCount * 4 >= sceneItems;
+    if (m_batchUnindexed) scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+}
+
+void GraphVisualizer::commitBatch()
+{
+    if (m_batchDepth == 0 || --m_batchDepth > 0) return;
+
+    for (Edge* e : m_batchDirtyEdges) {
+        e->adjust();
+    }
+    m_batchDirtyEdges.clear();
+
+    // Индекс строится заново один раз - тот, что был до пакета
+    if (m_batchUnindexed) scene->setItemIndexMethod(m_batchIndexMethod);
+    m_batchUnindexed = false;
+}
+
+QList<VertexItem*> GraphVisualizer::addVertices(const QList<QPointF>& positions)
+{
+    QList<VertexItem*> vertices;
+    vertices.reserve(positions.size());
+
+    beginBatch(positions.size());
+    for (const QPointF& position : positions) {
+        vertices.append(addVertex(position));
+    }
+    commitBatch();
+    return vertices;
+}
+
+QList<Edge*> GraphVisualizer::addEdges(const QList<QPair<VertexItem*, VertexItem*>>& ends, int weight)
+{
+    QList<Edge*> edges;
+    edges.reserve(ends.size());
+
+    beginBatch(ends.size());
+    for (const auto& pair : ends) {
+        edges.append(addEdge(pair.first, pair.second, weight));
+    }
+    commitBatch();
+    return edges;
+}
+
+void GraphVisualizer::removeVertices(const QList<VertexItem*>& vertices)
+{
+    if (vertices.isEmpty()) return;
+
+    // Проигрывание и раскладку останавливаем один раз на весь пакет
+    stopPlayback();
+    stopLayout();
+
+    beginBatch();
+    for (VertexItem* v : vertices) {
+        // Повтор в списке или уже удаленная вершина - пропускаем
+        if (m_vertexIndex.contains(v)) destroyVertex(v);
+    }
+    commitBatch();
+}
+
+void GraphVisualizer::removeEdges(const QList<Edge*>& edges)
+{
+    if (edges.isEmpty()) return;
+
+    stopPlayback();
+    stopLayout();
+    ensureEdgeIndex();
+
+    beginBatch();
+    for (Edge* e : edges) {
+        // Ребро могло уйти раньше вместе с вершиной или стоять в списке дважды
+        if (m_edgeIndex.contains(e)) destroyEdge(e, nullptr);
+    }
+    commitBatch();
+}
+
+void GraphVisualizer::beginFrame()
+{
+    m_frame.begin(int(m_vertexItems.size()), int(m_edgeItems.size()));
+}
+
+void GraphVisualizer::foldStep(const AlgorithmStep& step)
+{
+    m_frame.fold(step);
+}
+
+void GraphVisualizer::flushFrame()
+{
+    m_frame.flush(m_vertexItems, m_edgeItems);
+    updateTimelineSlider();
+}
+
+void GraphVisualizer::applySteps(qsizetype count)
+{
+    const qsizetype end = qMin(currentSteps.size(), m_stepCursor + count);
+    if (m_stepCursor >= end) return;
+
+    beginFrame();
+    while (m_stepCursor < end) {
+        // Распаковываем очередной шаг трассы (на стеке, без выделения памяти)
+        foldStep(currentSteps.at(m_stepCursor++));
+    }
+    flushFrame();
+}
+
+void GraphVisualizer::finishPlaybackIfDone()
+{
+    // Расчет еще идет - следующие шаги скоро придут, просто ждем
+    if (m_stepCursor < currentSteps.size() || m_solverRunning) return;
+
+    actNextStep->setEnabled(false); // Если шаги кончились, гасим кнопку
+    actAutoPlay->setEnabled(false);
+    actSkipToEnd->setEnabled(false);
+
+    // Останавливаем таймер, если он работал
+    if (autoPlayTimer->isActive()) {
+        autoPlayTimer->stop();
+        actAutoPlay->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+    }
+}
+
+void GraphVisualizer::seekTo(qsizetype position)
+{
+    position = qBound(qsizetype(0), position, currentSteps.size());
+    if (position == m_stepCursor) return;
+
+    if (position > m_stepCursor && position - m_stepCursor <= m_timeline.interval()) {
+        // Недалеко вперед - просто доигрываем шаги
+        applySteps(position - m_stepCursor);
+    }
+    else {
+        // Назад или далеко вперед - берем ближайший снимок и доигрываем от него
+        m_timeline.colorsAt(currentSteps, position, m_seekVertexColors, m_seekEdgeColors);
+
+        const int vertexCount = int(qMin(m_vertexItems.size(), qsizetype(m_seekVertexColors.size())));
+        for (int i = 0; i < vertexCount; ++i) {
+            m_vertexItems[i]->setColor(QColor::fromRgba(m_seekVertexColors[i]));
+        }
+        const int edgeCount = int(qMin(m_edgeItems.size(), qsizetype(m_seekEdgeColors.size())));
+        for (int i = 0; i < edgeCount; ++i) {
+            m_edgeItems[i]->setColor(QColor::fromRgba(m_seekEdgeColors[i]));
+        }
+
+        m_stepCursor = position;
+        updateTimelineSlider();
+    }
+
+    // После перемотки назад снова есть что проигрывать
+    const bool hasSteps = m_stepCursor < currentSteps.size() || m_solverRunning;
+    actNextStep->setEnabled(hasSteps);
+    actAutoPlay->setEnabled(hasSteps);
+    actSkipToEnd->setEnabled(hasSteps);
+    finishPlaybackIfDone();
+}
+
+void GraphVisualizer::onTimelineMoved(int position)
+{
+    // Перемотка во время расчета "в конец" отменяет режим догона
+    m_skipToEnd = false;
+    seekTo(position);
+}
+
+void GraphVisualizer::updateTimelineSlider()
+{
+    // Программная установка не должна вызывать перемотку
+    const QSignalBlocker blocker(m_timelineSlider);
+    m_timelineSlider->setRange(0, int(currentSteps.size()));
+    m_timelineSlider->setValue(int(m_stepCursor));
+    m_timelineSlider->setEnabled(!currentSteps.isEmpty());
+    m_timelineLabel->setText(QString("%1 / %2").arg(m_stepCursor).arg(currentSteps.size()));
+}
+
+void GraphVisualizer::onEdgeLayerToggled(bool enabled)
+{
+    setEdgeLayerEnabled(enabled);
+}
+
+void GraphVisualizer::setEdgeLayerEnabled(bool enabled)
+{
+    if (enabled == (m_edgeLayer != nullptr)) return;
+
+    if (enabled) {
+        // Переносим ребра из сцены в слой (цвета и геометрия сохраняются)
+        m_edgeLayer = new EdgeLayer();
+        scene->addItem(m_edgeLayer);
+
+        for (Edge* e : m_edgeItems) {
+            scene->removeItem(e);
+            e->attachToLayer(m_edgeLayer);
+        }
+    }
+    else {
+        // Возвращаем ребра в сцену отдельными элементами
+        for (Edge* e : m_edgeItems) {
+            e->detachFromLayer();
+            scene->addItem(e);
         }
+
+        scene->removeItem(m_edgeLayer);
+        delete m_edgeLayer;
+        m_edgeLayer = nullptr;
+    }
+}
+
+void GraphVisualizer::onLayoutToggled(bool enabled)
+{
+    if (enabled) startLayout();
+    else stopLayout();
+}
+
+void GraphVisualizer::startLayout()
+{
+    // Прежний прогон (если был) больше не нужен
+    m_layoutWatcher->cancel();
+
+    GraphStore graph;
+    if (!loadGraph(graph)) {
+        const QSignalBlocker blocker(actLayout);
+        actLayout->setChecked(false);
         return;
     }
 
-    // Берем первый шаг из очереди
-    AlgorithmStep step = currentSteps.dequeue();
+    const quint64 runId = ++m_layoutRunId;
+    m_layoutFramePending = false;
+
+    // Итерации идут без остановки; кадр отдаем, только когда GUI применил прошлый,
+    // иначе очередь забьется координатами, которые всё равно устареют
+    QFuture<void> future = QtConcurrent::run(
+        [this, runId, graph = std::move(graph)](QPromise<void>& promise) {
+            ForceLayout layout;
+            layout.setGraph(graph.view());
+
+            QElapsedTimer frameClock;
+            frameClock.start();
+
+            bool running = true;
+            while (running) {
+                if (promise.isCanceled()) return;
+                running = layout.step();
+
+                if (running && (frameClock.elapsed() < LayoutFrameInterval || m_layoutFramePending)) continue;
 
-    if (step.type == StepType::ResetColors) {
-        // Сброс всех цветов
-        for (QGraphicsItem* item : scene->items()) {
-            if (VertexItem* v = dynamic_cast<VertexItem*>(item)) {
-                v->setColor(Qt::white);
+                QList<QPointF> positions;
+                positions.reserve(layout.vertexCount());
+                for (int i = 0; i < layout.vertexCount(); ++i) {
+                    positions.append(QPointF(layout.xs()[i], layout.ys()[i]));
+                }
+
+                m_layoutFramePending = true;
+                emit layoutReady(runId, positions, layout.iteration(), !running);
+                frameClock.restart();
             }
-            if (Edge* e = dynamic_cast<Edge*>(item)) {
-                e->setColor(Qt::black);
+        });
+
+    m_layoutWatcher->setFuture(future);
+    trackFuture(m_layoutFutures, future);
+}
+
+void GraphVisualizer::stopLayout()
+{
+    // Новый номер прогона: кадры, уже стоящие в очереди (и последний кадр
+    // только что закончившейся раскладки), будут отброшены
+    m_layoutWatcher->cancel();
+    m_layoutRunId++;
+
+    const QSignalBlocker blocker(actLayout);
+    actLayout->setChecked(false);
+}
+
+void GraphVisualizer::onLayoutReady(quint64 runId, const QList<QPointF>& positions, int iteration, bool finished)
+{
+    // Отметку снимаем и для устаревших кадров: прерванный прогон мог поставить ее напоследок
+    m_layoutFramePending = false;
+    if (runId != m_layoutRunId) return;
+
+    // Сначала двигаем все вершины, потом подтягиваем каждое ребро один раз -
+    // а не по разу на каждый конец и не на каждой итерации раскладки
+    const int count = qMin(int(positions.size()), int(m_vertexItems.size()));
+    QRectF bounds;
+    for (int i = 0; i < count; ++i) {
+        m_vertexItems[i]->setPosBatched(positions[i]);
+        bounds |= QRectF(positions[i], QSizeF(1, 1));
+    }
+    for (Edge* e : m_edgeItems) {
+        e->adjust();
+    }
+
+    // Сцена только растет, чтобы вид не прыгал от кадра к кадру
+    scene->setSceneRect(scene->sceneRect() | bounds.adjusted(-50, -50, 50, 50));
+    statusBar()->showMessage(QString("Раскладка: итерация %1").arg(iteration), finished ? 5000 : 0);
+
+    if (finished) {
+        const QSignalBlocker blocker(actLayout);
+        actLayout->setChecked(false);
+    }
+}
+
+void GraphVisualizer::executeStep()
+{
+    applySteps(1);
+    finishPlaybackIfDone();
+}
+
+void GraphVisualizer::onFrame()
+{
+    const qsizetype available = currentSteps.size() - m_stepCursor;
+    const qsizetype cursorBefore = m_stepCursor;
+    QElapsedTimer applyTime;
+    applyTime.start();
+
+    if (m_stepsPerSecond == 0) {
+        // Без ограничения: сворачиваем шаги пачками, пока не выйдет время кадра
+        QElapsedTimer frameTime;
+        frameTime.start();
+
+        beginFrame();
+        while (m_stepCursor < currentSteps.size() && frameTime.elapsed() < FrameBudgetMs) {
+            const qsizetype end = qMin(currentSteps.size(), m_stepCursor + FastBatchSize);
+            while (m_stepCursor < end) {
+                foldStep(currentSteps.at(m_stepCursor++));
             }
-            // Ребрам цвет пока не меняли (они всегда черные, но можно добавить метод setColor и в Edge)
         }
+        flushFrame();
     }
-    else if (step.type == StepType::HighlightNode) {
-        VertexItem* v = static_cast<VertexItem*>(step.item);
-        if (v) v->setColor(step.color);
+    else {
+        // Сколько шагов "набежало" с прошлого кадра при заданной скорости
+        m_stepBudget += m_frameClock.restart() * m_stepsPerSecond / 1000.0;
+        const qsizetype count = qsizetype(m_stepBudget);
+        m_stepBudget -= double(count);
+
+        // Ждем порций от расчета - долг не копим, иначе потом будет рывок
+        if (count >= available) m_stepBudget = 0;
+
+        applySteps(count);
     }
-    else if (step.type == StepType::HighlightEdge) {
-        Edge* e = static_cast<Edge*>(step.item);
-        // Тут нужен метод setColor в Edge (если его нет - ребро останется черным)
-        if (e) e->setColor(step.color); 
+
+    // Метрики автоплея: время между тиками - это время показа, из него на шаги ушло applyTime
+    m_metrics.applyMs += applyTime.nsecsElapsed() / 1e6;
+    m_metrics.playMs += m_playClock.nsecsElapsed() / 1e6;
+    m_playClock.restart();
+    m_metrics.playedSteps += m_stepCursor - cursorBefore;
+    m_metrics.frames++;
+    if (m_metricsLabelClock.elapsed() >= MetricsLabelInterval) updateMetricsLabel();
+
+    finishPlaybackIfDone();
+}
+
+void GraphVisualizer::onSkipToEnd()
+{
+    // Все оставшиеся шаги сворачиваются в итоговые цвета за один кадр
+    applySteps(currentSteps.size() - m_stepCursor);
+
+    // Если расчет еще идет, новые порции будут применяться сразу по приходу
+    m_skipToEnd = m_solverRunning;
+    if (m_skipToEnd && autoPlayTimer->isActive()) {
+        autoPlayTimer->stop();
+        actAutoPlay->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
     }
+
+    finishPlaybackIfDone();
+}
+
+void GraphVisualizer::onSpeedChanged(int position)
+{
+    m_stepsPerSecond = SpeedSteps[position];
+    m_speedLabel->setText(m_stepsPerSecond == 0 ? QString("макс.") : QString("%1 шаг/с").arg(m_stepsPerSecond));
 }
 
 void GraphVisualizer::onNextStep()
@@ -183,153 +873,339 @@ void GraphVisualizer::onNextStep()
     executeStep();
 }
 
-void GraphVisualizer::startBFS(int startId)
+bool GraphVisualizer::loadGraph(GraphStore& graph)
 {
-    // 1. Сбрасываем старое (на всякий случай)
-    actNextStep->setEnabled(false);
-    actAutoPlay->setEnabled(false);
-    if (autoPlayTimer->isActive()) onAutoPlay();
-    // Или просто:
-    solver = GraphSolver();
-    currentSteps.clear();
+    // Реестр уже разложен по индексам: копируем в решатель только данные
+    if (m_vertexItems.isEmpty()) return false;
 
-    // 2. Собираем данные со сцены
-    QList<VertexItem*> vertices;
-    QList<Edge*> edges;
+    graph.clear();
+    graph.reserve(int(m_vertexItems.size()), int(m_edgeItems.size()));
 
-    for (QGraphicsItem* item : scene->items()) {
-        if (VertexItem* v = dynamic_cast<VertexItem*>(item)) vertices.append(v);
-        else if (Edge* e = dynamic_cast<Edge*>(item)) edges.append(e);
+    for (VertexItem* v : m_vertexItems) {
+        graph.addVertex(v->getId(), float(v->x()), float(v->y()));
     }
 
-    if (vertices.isEmpty()) return;
+    for (Edge* e : m_edgeItems) {
+        graph.addEdge(m_vertexIndex.value(e->sourceNode(), -1),
+            m_vertexIndex.value(e->destNode(), -1),
+            e->getWeight());
+    }
+
+    return true;
+}
+
+bool GraphVisualizer::buildScene(const GraphSpan& graph)
+{
+    // Шаги сохраненной трассы ссылаются на индексы ребер - пропускать битые нельзя,
+    // поэтому проверяем всё до того, как что-то создать
+    const int vertexCount = graph.vertexCount();
+    for (int i = 0; i < graph.edgeCount(); ++i) {
+        const GraphEdge& e = graph.edges[i];
+        if (e.source < 0 || e.source >= vertexCount || e.target < 0 || e.target >= vertexCount) return false;
+    }
 
-    // 3. Загружаем и запускаем
-    solver.setGraphData(vertices, edges);
+    // Большой граф сразу переводим в режим слоя, пока ребер еще нет
+    if (graph.edgeCount() >= LargeGraphEdges) actEdgeLayer->setChecked(true);
+
+    // Реестр заполняется в порядке файла: индексы сцены совпадают с индексами графа
+    m_vertexItems.reserve(vertexCount);
+    m_vertexIndex.reserve(vertexCount);
+    if (!m_edgeLayer) {
+        m_edgeItems.reserve(graph.edgeCount());
+        m_edgeIndex.reserve(graph.edgeCount());
+        m_edgeByEnds.reserve(graph.edgeCount());
+    }
 
-    // Используем переданный ID
-    currentSteps = solver.runBFS(startId);
+    // Одним пакетом: индекс сцены строится один раз в конце.
+    // Новые вершины потом продолжат нумерацию файла (addVertex двигает счетчик)
+    beginBatch(vertexCount + (m_edgeLayer ? 0 : graph.edgeCount()));
 
-    // 4. Активируем интерфейс
+    QRectF bounds;
+    for (int i = 0; i < vertexCount; ++i) {
+        const GraphVertex& gv = graph.vertices[i];
+        const QPointF position(gv.x, gv.y);
+        addVertex(gv.id, position);
+        bounds |= QRectF(position, QSizeF(1, 1));
+    }
+
+    // Ребра - как в файле, вместе с петлями и повторами: на их индексы ссылается трасса
+    if (m_edgeLayer) {
+        createLayerEdges(graph);
+    }
+    else {
+        for (int i = 0; i < graph.edgeCount(); ++i) {
+            const GraphEdge& ge = graph.edges[i];
+            createEdge(m_vertexItems[ge.source], m_vertexItems[ge.target], ge.weight);
+        }
+    }
+
+    commitBatch();
+
+    // Сцена покрывает весь граф (но не меньше стартовой), показываем его целиком
+    scene->setSceneRect(bounds.adjusted(-50, -50, 50, 50) | QRectF(0, 0, 800, 600));
+    view->fitInView(scene->sceneRect(), Qt::KeepAspectRatio);
+
+    return true;
+}
+
+void GraphVisualizer::startPlayback()
+{
+    // Активируем интерфейс
     if (!currentSteps.isEmpty()) {
         actNextStep->setEnabled(true);
         actAutoPlay->setEnabled(true);
+        actSkipToEnd->setEnabled(true);
         executeStep(); // Сразу выполняем первый шаг (сброс цветов)
     }
 }
 
-void GraphVisualizer::startDFS(int startId)
+void GraphVisualizer::stopPlayback()
 {
-    // 1. Сброс
-    solver = GraphSolver();
+    onCancel();
+
     currentSteps.clear();
+    m_stepCursor = 0;
+    m_stepBudget = 0;
+    m_skipToEnd = false;
+    m_timeline.clear();
+    updateTimelineSlider();
 
-    // 2. Сбор данных
-    QList<VertexItem*> vertices;
-    QList<Edge*> edges;
-    for (QGraphicsItem* item : scene->items()) {
-        if (VertexItem* v = dynamic_cast<VertexItem*>(item)) vertices.append(v);
-        else if (Edge* e = dynamic_cast<Edge*>(item)) edges.append(e);
+    actNextStep->setEnabled(false);
+    actAutoPlay->setEnabled(false);
+    actSkipToEnd->setEnabled(false);
+
+    if (autoPlayTimer->isActive()) {
+        autoPlayTimer->stop();
+        actAutoPlay->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
     }
-    if (vertices.isEmpty()) return;
+}
 
-    // 3. Загрузка
-    solver.setGraphData(vertices, edges);
+void GraphVisualizer::runAlgorithm(const QString& name, GeneratorFactory makeGenerator)
+{
+    // Сцену вот-вот заменит импортированный граф (и индикатор сейчас у импорта)
+    if (m_importWatcher->isRunning()) {
+        statusBar()->showMessage("Идет импорт - дождитесь его или прервите", 5000);
+        return;
+    }
 
-    // 4. ЗАПУСК ИМЕННО DFS
-    currentSteps = solver.runDFS(startId);
+    // 1. Сбрасываем старое
+    stopPlayback();
+    m_traceName = name;
 
-    // 5. Интерфейс
-    if (!currentSteps.isEmpty()) {
-        actNextStep->setEnabled(true);
-        actAutoPlay->setEnabled(true);
-        executeStep();
-    }
+    // 2. Собираем данные со сцены. Рабочий поток получает свою копию графа,
+    //    так что сцену можно править, пока идет расчет
+    GraphStore graph;
+    if (!loadGraph(graph)) return;
+
+    beginMetrics(name, graph.vertexCount(), graph.edgeCount());
+    m_timeline.reset(graph.vertexCount(), graph.edgeCount());
+
+    const quint64 runId = ++m_runId;
+
+    // 3. Считаем в пуле потоков, отдавая шаги порциями
+    QFuture<void> future = QtConcurrent::run(
+        [this, runId, graph = std::move(graph), makeGenerator = std::move(makeGenerator)](QPromise<void>& promise) mutable {
+            QElapsedTimer clock;
+            clock.start();
+
+            GraphSolver solver;
+            solver.setGraphData(std::move(graph));
+            const double prepareMs = clock.nsecsElapsed() / 1e6;
+            clock.restart();
+
+            std::unique_ptr<StepGenerator> generator = makeGenerator(solver);
+
+            promise.setProgressRange(0, ProgressScale);
+
+            AlgorithmTrace batch;
+            qsizetype batchLimit = FirstBatchSize;
+            qsizetype produced = 0;
+            AlgorithmStep step;
+            while (generator->next(step)) {
+                batch.append(step);
+
+                if (++produced % ProgressInterval == 0) {
+                    if (promise.isCanceled()) return;
+
+                    const qint64 total = generator->workTotal();
+                    if (total > 0) {
+                        promise.setProgressValue(int(generator->workDone() * ProgressScale / total));
+                    }
+                }
+
+                if (batch.size() >= batchLimit) {
+                    if (promise.isCanceled()) return;
+                    emit stepsReady(runId, batch);
+                    batch.clear();
+                    batchLimit = BatchSize;
+                }
+            }
+
+            if (promise.isCanceled()) return;
+            if (!batch.isEmpty()) {
+                emit stepsReady(runId, batch);
+            }
+            // Время расчета - вместе с отправкой порций: столько GUI ждет полной трассы
+            emit solverMeasured(runId, generator->counters(), prepareMs, clock.nsecsElapsed() / 1e6);
+            promise.setProgressValue(ProgressScale);
+        });
+
+    m_solverWatcher->setFuture(future);
+    trackFuture(m_solverFutures, future);
+    m_solverRunning = true;
+
+    // 4. Интерфейс: пока считаем, можно прервать
+    m_progressBar->setValue(0);
+    m_progressAction->setVisible(true);
+    actCancel->setEnabled(true);
 }
 
-void GraphVisualizer::startDijkstra(int startId)
+void GraphVisualizer::onStepsReady(quint64 runId, const AlgorithmTrace& steps)
 {
-    // 1. Сброс
-    solver = GraphSolver();
-    currentSteps.clear();
+    // Порция от прерванного прогона (уже стояла в очереди) - выбрасываем
+    if (runId != m_runId) return;
 
-    // 2. Сбор данных
-    QList<VertexItem*> vertices;
-    QList<Edge*> edges;
-    for (QGraphicsItem* item : scene->items()) {
-        if (VertexItem* v = dynamic_cast<VertexItem*>(item)) vertices.append(v);
-        else if (Edge* e = dynamic_cast<Edge*>(item)) edges.append(e);
+    // Первая порция запускает проигрывание, остальные просто дописываются
+    const bool first = currentSteps.isEmpty();
+    if (first) {
+        currentSteps = steps;
+    }
+    else {
+        currentSteps.append(steps);
     }
-    if (vertices.isEmpty()) return;
 
-    // 3. Загрузка
-    solver.setGraphData(vertices, edges);
+    // Снимки для перемотки считаем сразу по приходу шагов
+    m_timeline.extend(currentSteps);
+    updateTimelineSlider();
 
-    // 4. ЗАПУСК
-    currentSteps = solver.runDijkstra(startId);
+    if (first) startPlayback();
 
-    // 5. Интерфейс
-    if (!currentSteps.isEmpty()) {
-        actNextStep->setEnabled(true);
-        actAutoPlay->setEnabled(true);
-        executeStep();
+    // Пользователь уже попросил конец - догоняем без анимации
+    if (m_skipToEnd) {
+        applySteps(currentSteps.size() - m_stepCursor);
     }
 }
 
-void GraphVisualizer::startConnectedComponents()
+void GraphVisualizer::onSolverFinished()
 {
-    // 1. Сброс
-    solver = GraphSolver();
-    currentSteps.clear();
+    m_solverRunning = false;
+    actCancel->setEnabled(false);
+    m_progressAction->setVisible(false);
 
-    // 2. Сбор данных
-    QList<VertexItem*> vertices;
-    QList<Edge*> edges;
-    for (QGraphicsItem* item : scene->items()) {
-        if (VertexItem* v = dynamic_cast<VertexItem*>(item)) vertices.append(v);
-        else if (Edge* e = dynamic_cast<Edge*>(item)) edges.append(e);
+    // Проигрывание могло уже дойти до конца и ждать этих шагов
+    if (!currentSteps.isEmpty()) finishPlaybackIfDone();
+}
+
+void GraphVisualizer::onCancel()
+{
+    // Импорт замечает отмену между кусками файла; сцену не трогаем - она еще старая
+    if (m_importWatcher->isRunning()) {
+        m_importWatcher->cancel();
+        return;
     }
-    if (vertices.isEmpty()) return;
 
-    // 3. Загрузка
-    solver.setGraphData(vertices, edges);
+    if (!m_solverRunning) return;
 
-    // 4. ЗАПУСК
-    currentSteps = solver.runConnectedComponents();
+    // Новый номер прогона: порции, уже стоящие в очереди, будут отброшены
+    m_solverWatcher->cancel();
+    m_runId++;
+    onSolverFinished();
 
-    // 5. Интерфейс
-    if (!currentSteps.isEmpty()) {
-        actNextStep->setEnabled(true);
-        actAutoPlay->setEnabled(true);
-        executeStep();
-    }
+    // Прерванный прогон остается в метриках с тем, что успел насчитать
+    m_metrics.steps = currentSteps.size();
+    m_metrics.traceBytes = currentSteps.memoryUsage();
+    updateMetricsLabel();
 }
 
-void GraphVisualizer::startKruskal()
+void GraphVisualizer::onSolverMeasured(quint64 runId, const SolverCounters& counters, double prepareMs, double solveMs)
 {
-    // 1. Сброс
-    solver = GraphSolver();
-    currentSteps.clear();
+    if (runId != m_runId) return;
+
+    // Порции шагов отправлены раньше этого сигнала - трасса уже полная
+    m_metrics.completed = true;
+    m_metrics.prepareMs = prepareMs;
+    m_metrics.solveMs = solveMs;
+    m_metrics.counters = counters;
+    m_metrics.steps = currentSteps.size();
+    m_metrics.traceBytes = currentSteps.memoryUsage();
+    updateMetricsLabel();
+}
 
-    // 2. Сбор данных
-    QList<VertexItem*> vertices;
-    QList<Edge*> edges;
-    for (QGraphicsItem* item : scene->items()) {
-        if (VertexItem* v = dynamic_cast<VertexItem*>(item)) vertices.append(v);
-        else if (Edge* e = dynamic_cast<Edge*>(item)) edges.append(e);
-    }
-    if (vertices.isEmpty()) return;
+void GraphVisualizer::beginMetrics(const QString& name, int vertexCount, int edgeCount)
+{
+    if (!m_metrics.algorithm.isEmpty()) m_metricsHistory.append(m_metrics);
+
+    m_metrics = RunMetrics();
+    m_metrics.algorithm = name;
+    m_metrics.started = QDateTime::currentDateTime();
+    m_metrics.vertices = vertexCount;
+    m_metrics.edges = edgeCount;
+    updateMetricsLabel();
+}
 
-    // 3. Загрузка и Запуск
-    solver.setGraphData(vertices, edges);
-    currentSteps = solver.runKruskal();
+void GraphVisualizer::updateMetricsLabel()
+{
+    m_metricsLabel->setText(m_metrics.algorithm.isEmpty() ? QString() : m_metrics.summary());
+    m_metricsLabelClock.start();
+}
 
-    // 4. Интерфейс
-    if (!currentSteps.isEmpty()) {
-        actNextStep->setEnabled(true);
-        actAutoPlay->setEnabled(true);
-        executeStep();
+void GraphVisualizer::startBFS(int startId)
+{
+    // Запускаем, используя переданный ID
+    runAlgorithm("BFS", [startId](const GraphSolver& solver) { return solver.makeBFS(startId); });
+}
+
+void GraphVisualizer::startParallelBFS(int startId)
+{
+    // Считается целиком, шаги - по уровням: показ начнется после расчета
+    runAlgorithm("ParallelBFS", [startId](const GraphSolver& solver) { return solver.makeParallelBFS(startId); });
+}
+
+void GraphVisualizer::startDFS(int startId)
+{
+    // ЗАПУСК ИМЕННО DFS
+    runAlgorithm("DFS", [startId](const GraphSolver& solver) { return solver.makeDFS(startId); });
+}
+
+void GraphVisualizer::startDijkstra(int startId)
+{
+    runAlgorithm("Dijkstra", [startId](const GraphSolver& solver) { return solver.makeDijkstra(startId); });
+}
+
+void GraphVisualizer::startDeltaStepping(int startId)
+{
+    // Решатель на отрицательных весах вернет пустой результат - скажем об этом сразу
+    for (Edge* e : m_edgeItems) {
+        if (e->getWeight() < 0) {
+            statusBar()->showMessage("Delta-stepping: в графе есть ребра с отрицательным весом - не считаем", 5000);
+            return;
+        }
     }
+
+    // Ширина корзины: 0 - подобрать по весам ребер
+    bool ok;
+    const int delta = QInputDialog::getInt(this, "Delta-stepping",
+        "Ширина корзины (0 - подобрать автоматически):", 0, 0, 1000000, 1, &ok);
+    if (!ok) return;
+
+    runAlgorithm("DeltaStepping", [startId, delta](const GraphSolver& solver) {
+        return solver.makeDeltaStepping(startId, delta);
+    });
+}
+
+void GraphVisualizer::startConnectedComponents()
+{
+    runAlgorithm("Components", [](const GraphSolver& solver) { return solver.makeConnectedComponents(); });
+}
+
+void GraphVisualizer::startParallelComponents()
+{
+    runAlgorithm("ParallelComponents", [](const GraphSolver& solver) { return solver.makeParallelComponents(); });
+}
+
+void GraphVisualizer::startKruskal()
+{
+    runAlgorithm("Kruskal", [](const GraphSolver& solver) { return solver.makeKruskal(); });
 }
 
 void GraphVisualizer::setupUiCustom()
@@ -338,10 +1214,80 @@ void GraphVisualizer::setupUiCustom()
     toolbar = addToolBar("Main Toolbar");
     toolbar->setMovable(false); // Зафиксировать, чтобы не таскали
 
+    // Файлы графа: открыть / сохранить вместе с трассой
+    actOpen = toolbar->addAction(style()->standardIcon(QStyle::SP_DialogOpenButton), "Открыть граф", this, &GraphVisualizer::onOpenGraph);
+    actSave = toolbar->addAction(style()->standardIcon(QStyle::SP_DialogSaveButton), "Сохранить граф", this, &GraphVisualizer::onSaveGraph);
+    actImport = toolbar->addAction(style()->standardIcon(QStyle::SP_FileDialogContentsView), "Импорт списка ребер", this, &GraphVisualizer::onImportGraph);
+    actExportMetrics = toolbar->addAction(style()->standardIcon(QStyle::SP_FileDialogDetailedView), "Экспорт метрик (JSON)", this, &GraphVisualizer::onExportMetrics);
+
+    // Метрики последнего прогона - справа в строке состояния
+    m_metricsLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_metricsLabel);
+    toolbar->addSeparator();
+
     QIcon iconRun = style()->standardIcon(QStyle::SP_MediaPlay);
     actAutoPlay = toolbar->addAction(iconRun, "Авто-запуск", this, &GraphVisualizer::onAutoPlay);
     actAutoPlay->setEnabled(false); // Пока алгоритм не выбран, запускать нечего
 
+    // Прервать расчет (активна, только пока алгоритм считается в фоне)
+    QIcon iconStop = style()->standardIcon(QStyle::SP_BrowserStop);
+    actCancel = toolbar->addAction(iconStop, "Прервать расчет", this, &GraphVisualizer::onCancel);
+    actCancel->setEnabled(false);
+
+    m_progressBar = new QProgressBar(toolbar);
+    m_progressBar->setRange(0, ProgressScale);
+    m_progressBar->setMaximumWidth(150);
+    m_progressBar->setTextVisible(false);
+    m_progressAction = toolbar->addWidget(m_progressBar);
+    m_progressAction->setVisible(false);
+
+    // Скорость автоплея и перемотка в конец
+    m_speedSlider = new QSlider(Qt::Horizontal, toolbar);
+    m_speedSlider->setRange(0, SpeedCount - 1);
+    m_speedSlider->setMaximumWidth(120);
+    m_speedSlider->setToolTip("Скорость воспроизведения");
+    toolbar->addWidget(m_speedSlider);
+
+    m_speedLabel = new QLabel(toolbar);
+    m_speedLabel->setMinimumWidth(70);
+    toolbar->addWidget(m_speedLabel);
+
+    connect(m_speedSlider, &QSlider::valueChanged, this, &GraphVisualizer::onSpeedChanged);
+    m_speedSlider->setValue(DefaultSpeed);
+    onSpeedChanged(DefaultSpeed);
+
+    QIcon iconSkip = style()->standardIcon(QStyle::SP_MediaSkipForward);
+    actSkipToEnd = toolbar->addAction(iconSkip, "В конец", this, &GraphVisualizer::onSkipToEnd);
+    actSkipToEnd->setEnabled(false);
+
+    // Режим слоя ребер: для больших графов (ребра рисуются пачками, но не кликаются)
+    actEdgeLayer = toolbar->addAction("Слой ребер");
+    actEdgeLayer->setCheckable(true);
+    actEdgeLayer->setToolTip("Рисовать все ребра одним слоем - быстрее на больших графах");
+    connect(actEdgeLayer, &QAction::toggled, this, &GraphVisualizer::onEdgeLayerToggled);
+
+    // Силовая раскладка: пока кнопка нажата, вершины расползаются; отжать - остановить
+    actLayout = toolbar->addAction("Раскладка");
+    actLayout->setCheckable(true);
+    actLayout->setToolTip("Разложить граф силовым методом (Фрюхтерман - Рейнгольд, Барнс - Хат)");
+    connect(actLayout, &QAction::toggled, this, &GraphVisualizer::onLayoutToggled);
+
+    // Шкала времени внизу окна: перемотка к любому шагу трассы
+    QToolBar* timelineBar = new QToolBar("Шкала времени", this);
+    timelineBar->setMovable(false);
+    addToolBar(Qt::BottomToolBarArea, timelineBar);
+
+    m_timelineSlider = new QSlider(Qt::Horizontal, timelineBar);
+    m_timelineSlider->setToolTip("Перемотка по шагам алгоритма");
+    timelineBar->addWidget(m_timelineSlider);
+
+    m_timelineLabel = new QLabel(timelineBar);
+    m_timelineLabel->setMinimumWidth(120);
+    timelineBar->addWidget(m_timelineLabel);
+
+    connect(m_timelineSlider, &QSlider::valueChanged, this, &GraphVisualizer::onTimelineMoved);
+    updateTimelineSlider();
+
     toolbar->addSeparator();
 
     // 1. Кнопка ОЧИСТИТЬ (иконка "Мусорка")
@@ -362,18 +1308,217 @@ void GraphVisualizer::setupUiCustom()
 
 void GraphVisualizer::onClear()
 {
-    // Очищаем сцену
+    // В режиме слоя ребра не в сцене - сцена их не удалит
+    if (m_edgeLayer) qDeleteAll(m_edgeItems);
+
+    // Очищаем сцену (слой ребер удаляется вместе с ней)
     scene->clear();
+    m_edgeLayer = nullptr;
 
     // Сбрасываем внутренние переменные
-    solver = GraphSolver(); // Новый пустой решатель
-    currentSteps.clear();
     firstVertex = nullptr;
     nextId = 1; // Сбрасываем счетчик ID
 
-    // Блокируем кнопку "Далее"
-    actNextStep->setEnabled(false);
-    autoPlayTimer->stop();
+    // Останавливаем алгоритм и блокируем кнопку "Далее"
+    stopPlayback();
+    stopLayout();
+
+    // Элементы удалены вместе со сценой - забываем их
+    m_vertexItems.clear();
+    m_vertexIndex.clear();
+    m_edgeItems.clear();
+    m_edgeIndex.clear();
+    m_edgeByEnds.clear();
+    m_edgeIndexPending = false;
+    m_batchDirtyEdges.clear();
+
+    // Режим слоя сохраняется: заводим новый пустой слой
+    if (actEdgeLayer->isChecked()) setEdgeLayerEnabled(true);
+}
+
+void GraphVisualizer::onOpenGraph()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Открыть граф", QString(), GraphFileFilter);
+    if (path.isEmpty()) return;
+
+    // Файл отображается в память: сцена строится прямо из его страниц, без разбора текста
+    QElapsedTimer clock;
+    clock.start();
+    GraphFile file;
+    if (!file.open(path)) {
+        QMessageBox::warning(this, "Открыть граф", file.errorString());
+        return;
+    }
+    const qint64 openMs = clock.elapsed();
+
+    onClear();
+    clock.restart();
+    if (!buildScene(file.graph())) {
+        QMessageBox::warning(this, "Открыть граф", "В файле есть ребра с несуществующими вершинами");
+        return;
+    }
+
+    // Время открытия видно сразу: цель - граф на 1 млн ребер заметно быстрее секунды
+    statusBar()->showMessage(QString("Открыт: %1 вершин, %2 ребер - файл %3 мс, сцена %4 мс")
+        .arg(file.graph().vertexCount())
+        .arg(file.graph().edgeCount())
+        .arg(openMs)
+        .arg(clock.elapsed()));
+
+    // Сохраненная трасса приходит целиком: снимки перемотки строим сразу и начинаем показ
+    if (file.traceCount() > 0) {
+        currentSteps = file.trace(0);
+        m_traceName = file.traceName(0);
+
+        // Трасса не считалась - в метриках только ее размер и дальнейший автоплей
+        beginMetrics(m_traceName, file.graph().vertexCount(), file.graph().edgeCount());
+        m_metrics.loaded = true;
+        m_metrics.completed = true;
+        m_metrics.steps = currentSteps.size();
+        m_metrics.traceBytes = currentSteps.memoryUsage();
+        updateMetricsLabel();
+
+        m_timeline.reset(file.graph().vertexCount(), file.graph().edgeCount());
+        m_timeline.extend(currentSteps);
+        updateTimelineSlider();
+        startPlayback();
+    }
+}
+
+void GraphVisualizer::onSaveGraph()
+{
+    GraphStore graph;
+    if (!loadGraph(graph)) {
+        QMessageBox::information(this, "Сохранить граф", "Граф пуст - сохранять нечего");
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Сохранить граф", QString(), GraphFileFilter);
+    if (path.isEmpty()) return;
+
+    // Трассу пишем, только если расчет закончен: недосчитанная трасса неполная
+    QList<GraphFile::Trace> traces;
+    if (!currentSteps.isEmpty() && !m_solverRunning) {
+        traces.append({ m_traceName, currentSteps });
+    }
+
+    QString error;
+    if (!GraphFile::save(path, graph.view(), traces, &error)) {
+        QMessageBox::warning(this, "Сохранить граф", error);
+    }
+}
+
+void GraphVisualizer::onImportGraph()
+{
+    if (m_importWatcher->isRunning()) return;
+
+    const QString path = QFileDialog::getOpenFileName(this, "Импорт списка ребер", QString(), ImportFilter);
+    if (path.isEmpty()) return;
+
+    // Старый граф всё равно будет заменен - его расчет и раскладка больше не нужны
+    stopPlayback();
+    stopLayout();
+
+    // Разбор и сборка графа - в пуле потоков; задача не трогает окно, результат забирает onImportFinished
+    QFuture<ImportResult> future = QtConcurrent::run([path](QPromise<ImportResult>& promise) {
+        promise.setProgressRange(0, ProgressScale);
+
+        GraphImporter importer;
+        importer.setProgressFunction([&promise](qint64 done, qint64 total) {
+            promise.setProgressValue(int(done * ProgressScale / total));
+            return !promise.isCanceled();
+        });
+
+        ImportResult result;
+        if (importer.load(path)) {
+            // Координат в этих форматах нет - раскладываем вершины спиралью
+            result.graph = importer.takeGraph();
+            GraphImporter::spiralLayout(result.graph);
+        }
+        else if (importer.canceled()) {
+            return; // без результата: onImportFinished поймет, что импорт прерван
+        }
+        else {
+            result.error = importer.errorString();
+        }
+        result.stats = importer.stats();
+        promise.addResult(std::move(result));
+    });
+
+    m_importWatcher->setFuture(future);
+
+    actImport->setEnabled(false);
+    actOpen->setEnabled(false);
+    m_progressBar->setValue(0);
+    m_progressAction->setVisible(true);
+    actCancel->setEnabled(true);
+    statusBar()->showMessage("Импорт: " + QFileInfo(path).fileName());
+}
+
+void GraphVisualizer::onImportFinished()
+{
+    actImport->setEnabled(true);
+    actOpen->setEnabled(true);
+    actCancel->setEnabled(false);
+    m_progressAction->setVisible(false);
+
+    QFuture<ImportResult> future = m_importWatcher->future();
+    if (future.resultCount() == 0) {
+        statusBar()->showMessage("Импорт прерван", 5000);
+        return;
+    }
+
+    ImportResult result = future.takeResult();
+    if (!result.error.isEmpty()) {
+        statusBar()->clearMessage();
+        QMessageBox::warning(this, "Импорт", result.error);
+        return;
+    }
+
+    // Сцена - в GUI-потоке: элементы QGraphicsScene создаются только здесь
+    onClear();
+    if (!buildScene(result.graph.view())) {
+        statusBar()->clearMessage();
+        QMessageBox::warning(this, "Импорт", "В графе есть ребра с несуществующими вершинами");
+        return;
+    }
+
+    const GraphImporter::Stats& stats = result.stats;
+    statusBar()->showMessage(QString("Импорт: %1 вершин, %2 ребер (петель %3, повторов %4) - %5 МБ/с, всего %6 мс")
+        .arg(result.graph.vertexCount())
+        .arg(result.graph.edgeCount())
+        .arg(stats.skippedLoops)
+        .arg(stats.skippedDuplicates)
+        .arg(stats.megabytesPerSecond(), 0, 'f', 1)
+        .arg(stats.totalMs, 0, 'f', 0));
+
+    // Редактор дает веса 1..10000; отрицательные из файла оставляем как есть, но предупреждаем
+    if (stats.negativeWeights > 0) {
+        QMessageBox::warning(this, "Импорт",
+            QString("У %1 ребер отрицательный вес. Кратчайшие пути (Дейкстра, delta-stepping) "
+                "на таком графе неверны или не считаются").arg(stats.negativeWeights));
+    }
+}
+
+void GraphVisualizer::onExportMetrics()
+{
+    QList<RunMetrics> runs = m_metricsHistory;
+    if (!m_metrics.algorithm.isEmpty()) runs.append(m_metrics);
+
+    if (runs.isEmpty()) {
+        QMessageBox::information(this, "Экспорт метрик", "Алгоритмы еще не запускались - выгружать нечего");
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Экспорт метрик", QString(), MetricsFilter);
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!RunMetrics::exportJson(path, runs, &error)) {
+        QMessageBox::warning(this, "Экспорт метрик", error);
+        return;
+    }
+    statusBar()->showMessage(QString("Метрики: записано прогонов - %1").arg(runs.size()), 5000);
 }
 
 void GraphVisualizer::onAutoPlay()
@@ -385,9 +1530,12 @@ void GraphVisualizer::onAutoPlay()
         actAutoPlay->setText("Продолжить");
     }
     else {
-        // Если стоит -> запускаем (каждые 300 мс)
-        if (!currentSteps.isEmpty()) {
-            autoPlayTimer->start(300); // 300 мс задержка между шагами
+        // Если стоит -> запускаем (тик на каждый кадр, шагов за кадр - по скорости)
+        if (m_stepCursor < currentSteps.size() || m_solverRunning) {
+            m_frameClock.start();
+            m_playClock.start();
+            m_stepBudget = 0;
+            autoPlayTimer->start(FrameInterval);
             actAutoPlay->setIcon(style()->standardIcon(QStyle::SP_MediaPause)); // Меняем иконку на Pause
             actAutoPlay->setText("Пауза");
         }
@@ -417,6 +1565,11 @@ void GraphVisualizer::contextMenuEvent(QContextMenuEvent* event)
             connect(actBFS, &QAction::triggered, [this, v]() {
                 startBFS(v->getId()); });
 
+            QAction* actParallelBFS = menu.addAction("BFS по уровням (параллельно)");
+            connect(actParallelBFS, &QAction::triggered, [this, v]() {
+                startParallelBFS(v->getId());
+                });
+
             QAction* actDFS = menu.addAction("Запустить DFS отсюда");
             connect(actDFS, &QAction::triggered, [this, v]() {
                 startDFS(v->getId());
@@ -427,11 +1580,21 @@ void GraphVisualizer::contextMenuEvent(QContextMenuEvent* event)
                 startDijkstra(v->getId());
                 });
 
+            QAction* actDeltaStepping = menu.addAction("Дейкстра по корзинам (delta-stepping)");
+            connect(actDeltaStepping, &QAction::triggered, [this, v]() {
+                startDeltaStepping(v->getId());
+                });
+
             QAction* actComponents = menu.addAction("Найти компоненты связности");
             connect(actComponents, &QAction::triggered, [this]() {
                 startConnectedComponents();
                 });
 
+            QAction* actParallelComponents = menu.addAction("Компоненты связности (параллельно)");
+            connect(actParallelComponents, &QAction::triggered, [this]() {
+                startParallelComponents();
+                });
+
             QAction* actKruskal = menu.addAction("Найти мин. остовное дерево (Краскал)");
             connect(actKruskal, &QAction::triggered, [this]() {
                 startKruskal();
@@ -7,10 +7,29 @@
 #include <QGraphicsView>
 #include "VertexItem.h"
 #include "GraphSolver.h"
-#include <QQueue>
-#include <QTimer> //    ()
+#include <QTimer> // Для автоматического воспроизведения (опционально)
 #include <QContextMenuEvent>
 #include <QMenu>
+#include <QFutureWatcher>
+#include <QFutureSynchronizer>
+#include <QProgressBar>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QSlider>
+#include <QLabel>
+#include <QElapsedTimer>
+#include <vector>
+
+#include "TraceTimeline.h"
+#include "StepFrame.h"
+#include "EdgeLayer.h"
+#include "GraphFile.h"
+#include "GraphImporter.h"
+#include "ForceLayout.h"
+#include "RunMetrics.h"
+#include <atomic>
+#include <functional>
 
 class GraphVisualizer : public QMainWindow
 {
@@ -20,20 +39,73 @@ public:
     GraphVisualizer(QWidget *parent = nullptr);
     ~GraphVisualizer();
 
+    // --- Программная правка графа ---
+    // Правки можно собирать в пакет: ребра сдвинутых вершин подтягиваются один раз при commitBatch().
+    // itemCount - сколько элементов пакет добавит или сдвинет: если это сравнимо со всей сценой,
+    // до commitBatch() сцена не ведет индекс элементов (и строит его один раз в конце).
+    // Пакеты вкладываются (действует внешний); без пакета каждый вызов применяется сразу
+    void beginBatch(qsizetype itemCount = 0);
+    void commitBatch();
+
+    VertexItem* addVertex(QPointF position);             // ID - следующий по счетчику
+    VertexItem* addVertex(int id, QPointF position);
+    Edge* addEdge(VertexItem* a, VertexItem* b, int weight = 1); // nullptr - петля или такое ребро уже есть
+    Edge* findEdge(VertexItem* a, VertexItem* b) const;          // O(1) по хэшу концов
+    void moveVertex(VertexItem* v, QPointF position);
+    void removeVertex(VertexItem* v);                    // вместе со всеми ее ребрами
+    void removeEdge(Edge* e);
+
+    // То же списками, одним пакетом
+    QList<VertexItem*> addVertices(const QList<QPointF>& positions);
+    QList<Edge*> addEdges(const QList<QPair<VertexItem*, VertexItem*>>& ends, int weight = 1);
+    void removeVertices(const QList<VertexItem*>& vertices);
+    void removeEdges(const QList<Edge*>& edges);
+
 public slots:
-    void onClear(); //  
-    //   
+    void onClear(); // Слот очистки
+    // Слоты для кнопок
     void startBFS(int startId);
+    void startParallelBFS(int startId); // BFS по уровням в пуле потоков (для больших графов)
     void startDFS(int startId);
     void startDijkstra(int startId);
+    void startDeltaStepping(int startId); // Кратчайшие пути по корзинам в пуле потоков
     void startConnectedComponents();
+    void startParallelComponents(); // Компоненты в пуле потоков (Afforest), по компоненте за раз
     void startKruskal();
 
     void onAutoPlay();
     void onNextStep();
+    void onCancel(); // Прервать расчет алгоритма (уже полученные шаги остаются)
+
+    void onOpenGraph(); // Открыть файл графа (.gvg) вместе с сохраненной трассой
+    void onSaveGraph(); // Сохранить граф и текущую трассу
+    void onImportGraph(); // Импорт текстового списка ребер (SNAP, DIMACS, Matrix Market)
+    void onExportMetrics(); // Выгрузить метрики прогонов сеанса в JSON
+
+signals:
+    // Порция шагов из рабочего потока (соединение через очередь, обрабатывается в GUI)
+    void stepsReady(quint64 runId, const AlgorithmTrace& steps);
+    // Расчет закончен: счетчики генератора и время (после последней порции шагов)
+    void solverMeasured(quint64 runId, const SolverCounters& counters, double prepareMs, double solveMs);
+    // Кадр силовой раскладки: координаты всех вершин по индексам реестра
+    void layoutReady(quint64 runId, const QList<QPointF>& positions, int iteration, bool finished);
+
+private slots:
+    void onStepsReady(quint64 runId, const AlgorithmTrace& steps);
+    void onSolverFinished();
+    void onSolverMeasured(quint64 runId, const SolverCounters& counters, double prepareMs, double solveMs);
+    void onImportFinished();
+
+    void onFrame();                   // Тик автоплея: порция шагов на один кадр
+    void onSkipToEnd();               // Применить остаток трассы сразу, без анимации
+    void onSpeedChanged(int position);
+    void onTimelineMoved(int position); // Ползунок шкалы времени
+    void onEdgeLayerToggled(bool enabled);
+    void onLayoutToggled(bool enabled);
+    void onLayoutReady(quint64 runId, const QList<QPointF>& positions, int iteration, bool finished);
 
 protected:
-    //     
+    // Переопределяем событие вызова контекстного меню
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
@@ -43,31 +115,172 @@ private:
 
     QGraphicsScene* scene;
     QGraphicsView* view;
-    int nextId = 1;         //c   
+    int nextId = 1;         //cчетчик для номеров вершин
 
     bool eventFilter(QObject* watched, QEvent* event) override;
 
+    // Масштаб и панорама вида (true - событие обработано)
+    bool handleViewNavigation(QEvent* event);
+    bool m_panning = false;   // тянем вид средней кнопкой
+    QPoint m_panStart;
+
     VertexItem* firstVertex = nullptr;
 
-    void removeVertex(VertexItem* v);
-    void removeEdge(Edge* e);
+    // Ребро без проверок (петли и повторы допустимы - так строится граф из файла)
+    Edge* createEdge(VertexItem* a, VertexItem* b, int weight);
+    // Все ребра графа сразу в режиме слоя: слой заполняется пачкой, хэши ребер откладываются
+    void createLayerEdges(const GraphSpan& graph);
+    // Удалить ребро; из списка ребер вершины dying его не вычеркиваем - она удаляется целиком.
+    // Проигрывание и раскладку останавливает вызывающий (один раз, а не на каждое ребро)
+    void destroyEdge(Edge* e, VertexItem* dying);
+    // Удалить вершину вместе с ребрами; проигрывание и раскладку останавливает вызывающий
+    void destroyVertex(VertexItem* v);
+
+    // Концы ребра в фиксированном порядке - ключ хэша (ребро неориентированное)
+    using EdgeEnds = QPair<VertexItem*, VertexItem*>;
+    static EdgeEnds edgeEnds(VertexItem* a, VertexItem* b);
+    mutable QHash<EdgeEnds, Edge*> m_edgeByEnds;  // первое ребро с такими концами
+
+    int m_batchDepth = 0;
+    bool m_batchUnindexed = false;        // пакет снял индекс сцены - вернуть m_batchIndexMethod
+    QGraphicsScene::ItemIndexMethod m_batchIndexMethod = QGraphicsScene::BspTreeIndex;
+    QSet<Edge*> m_batchDirtyEdges;        // ребра сдвинутых в пакете вершин
+
+    // Алгоритм считается в пуле потоков над своей копией графа, GUI не блокируется.
+    // Фабрика вызывается в рабочем потоке и создает генератор у решателя-копии
+    using GeneratorFactory = std::function<std::unique_ptr<StepGenerator>(const GraphSolver&)>;
+    void runAlgorithm(const QString& name, GeneratorFactory makeGenerator);
+
+    QFutureWatcher<void>* m_solverWatcher;
+    QFutureSynchronizer<void> m_solverFutures; // все еще работающие прогоны (ждем их в деструкторе)
+    bool m_solverRunning = false; // рабочий поток еще может прислать шаги
+    quint64 m_runId = 0;          // номер прогона: порции от прерванных прогонов отбрасываем
+
+    AlgorithmTrace currentSteps;   // Уже полученные шаги (дописываются по мере расчета)
+    QString m_traceName;           // Какой алгоритм их дал (имя трассы в файле)
+    qsizetype m_stepCursor = 0;    // Номер следующего шага в трассе
+
+    // Реестр элементов графа: ведется при создании/удалении, сцену для этого не обходим.
+    // Позиция в списке - это индекс в GraphStore, хэш дает обратное отображение.
+    // Удаление переставляет последний элемент на место удаленного, поэтому
+    // перед удалением проигрывание останавливается (индексы шагов устаревают)
+    QList<VertexItem*> m_vertexItems;
+    QHash<VertexItem*, int> m_vertexIndex;
+    QList<Edge*> m_edgeItems;
+    mutable QHash<Edge*, int> m_edgeIndex;
 
-    GraphSolver solver;
-    QQueue<AlgorithmStep> currentSteps; //  ,   
+    // Открытый большой граф заполняет только m_edgeItems: хэши ребер (m_edgeIndex, m_edgeByEnds)
+    // нужны лишь правке графа и строятся при первом обращении к ним
+    mutable bool m_edgeIndexPending = false;
+    void ensureEdgeIndex() const;
+    void indexEdge(Edge* e, int position) const;
 
-    //    
+    // Режим слоя ребер: все ребра рисует один EdgeLayer (для больших графов).
+    // Сами Edge остаются в реестре, но не в сцене
+    EdgeLayer* m_edgeLayer = nullptr;
+    QAction* actEdgeLayer;
+    void setEdgeLayerEnabled(bool enabled);
+
+    // Силовая раскладка (ForceLayout) в пуле потоков над копией графа.
+    // Кадры приходят не чаще LayoutFrameInterval и не быстрее, чем GUI их применяет
+    void startLayout();
+    void stopLayout();
+
+    QAction* actLayout;
+    // Импорт текстового файла идет в пуле потоков: на огромных списках ребер разбор
+    // занимает секунды, окно при этом живо, индикатор и "Прервать" - те же, что у расчета
+    struct ImportResult {
+        GraphStore graph;
+        GraphImporter::Stats stats;
+        QString error;              // пусто - граф загружен
+    };
+    QFutureWatcher<ImportResult>* m_importWatcher;
+
+    QFutureWatcher<void>* m_layoutWatcher;
+    QFutureSynchronizer<void> m_layoutFutures; // прерванные раскладки тоже пишут m_layoutFramePending
+    quint64 m_layoutRunId = 0;
+    std::atomic<bool> m_layoutFramePending{ false }; // кадр отправлен, GUI его еще не применил
+
+    void registerVertex(VertexItem* v);
+    void registerEdge(Edge* e);
+    void unregisterVertex(VertexItem* v);
+    void unregisterEdge(Edge* e);
+
+    // Собрать граф со сцены в GraphStore (false - граф пуст)
+    bool loadGraph(GraphStore& graph);
+
+    // Обратное: построить сцену из готового графа одним проходом
+    // (сцена должна быть пуста; false - в графе битые индексы ребер)
+    bool buildScene(const GraphSpan& graph);
+
+    // Начать проигрывание currentSteps / остановить и забыть текущий алгоритм
+    void startPlayback();
+    void stopPlayback();
+
+    // Метод выполнения одного шага
     void executeStep();
 
+    // --- Покадровое применение шагов ---
+    // Шаги кадра сначала сворачиваются в итоговые цвета (StepFrame),
+    // потом каждый затронутый элемент перекрашивается ровно один раз
+    void applySteps(qsizetype count); // beginFrame + count шагов + flushFrame
+    void beginFrame();
+    void foldStep(const AlgorithmStep& step);
+    void flushFrame();
+    void finishPlaybackIfDone();      // Шаги кончились и новых не будет - гасим кнопки
+
+    StepFrame m_frame;
+
+    QElapsedTimer m_frameClock;  // время с прошлого кадра автоплея
+    double m_stepBudget = 0;     // дробный остаток шагов, не вошедших в прошлый кадр
+    int m_stepsPerSecond = 3;    // 0 - так быстро, как получится
+    bool m_skipToEnd = false;    // применять новые порции сразу по приходу
+
+    // --- Метрики прогонов ---
+    // Текущий прогон копится по ходу расчета и автоплея; новый прогон (или открытая
+    // из файла трасса) отправляет его в историю сеанса, которая и выгружается в JSON
+    void beginMetrics(const QString& name, int vertexCount, int edgeCount);
+    void updateMetricsLabel();
+
+    RunMetrics m_metrics;                 // algorithm пуст - прогонов еще не было
+    QList<RunMetrics> m_metricsHistory;
+    QElapsedTimer m_playClock;            // время автоплея с прошлого тика
+    QElapsedTimer m_metricsLabelClock;    // строку состояния во время автоплея обновляем не каждый кадр
+    QLabel* m_metricsLabel;
+
+    // --- Шкала времени ---
+    // Перейти к шагу position (применены шаги [0, position)) за O(интервала снимков)
+    void seekTo(qsizetype position);
+    void updateTimelineSlider();
+
+    TraceTimeline m_timeline;
+    std::vector<QRgb> m_seekVertexColors; // рабочие буферы перемотки
+    std::vector<QRgb> m_seekEdgeColors;
+    QSlider* m_timelineSlider;
+    QLabel* m_timelineLabel;
+
     QToolBar* toolbar;
     QAction* actClear;
     QAction* actNextStep;
+    QAction* actOpen;
+    QAction* actSave;
+    QAction* actImport;
+    QAction* actExportMetrics;
+
+    QTimer* autoPlayTimer; // Таймер для анимации
+    QAction* actAutoPlay;  // Кнопка Play/Pause
+    QAction* actSkipToEnd; // Перемотка в конец
+
+    QSlider* m_speedSlider; // Скорость автоплея
+    QLabel* m_speedLabel;
 
-    QTimer* autoPlayTimer; //   
-    QAction* actAutoPlay;  //  Play/Pause
+    QAction* actCancel;            // Прервать расчет
+    QProgressBar* m_progressBar;   // Ход расчета
+    QAction* m_progressAction;     // Место индикатора в тулбаре (прячем, когда не считаем)
 
-    //  
+    // Инициализация интерфейса
     void setupUiCustom();
 };
 
-// 
+//метки времени
 
@@ -0,0 +1,94 @@
+﻿#include "IndexedHeap.h"
+
+IndexedHeap::IndexedHeap(int capacity)
+{
+    reset(capacity);
+}
+
+void IndexedHeap::reset(int capacity)
+{
+    m_nodes.clear();
+    m_nodes.reserve(capacity);
+    m_position.assign(capacity, -1);
+}
+
+void IndexedHeap::push(int index, qint64 key)
+{
+    int pos = m_position[index];
+
+    if (pos < 0) {
+        pos = int(m_nodes.size());
+        m_nodes.push_back({ key, index });
+        m_position[index] = pos;
+    }
+    else if (key < m_nodes[pos].key) {
+        m_nodes[pos].key = key;
+    }
+    else {
+        return;
+    }
+
+    siftUp(pos);
+}
+
+int IndexedHeap::popMin()
+{
+    const int top = m_nodes.front().index;
+    m_position[top] = -1;
+
+    // Последний элемент ставим в корень и опускаем
+    Node last = m_nodes.back();
+    m_nodes.pop_back();
+
+    if (!m_nodes.empty()) {
+        m_nodes.front() = last;
+        m_position[last.index] = 0;
+        siftDown(0);
+    }
+
+    return top;
+}
+
+void IndexedHeap::siftUp(int pos)
+{
+    Node node = m_nodes[pos];
+
+    while (pos > 0) {
+        int parent = (pos - 1) / Arity;
+        if (!less(node, m_nodes[parent])) break;
+
+        m_nodes[pos] = m_nodes[parent];
+        m_position[m_nodes[pos].index] = pos;
+        pos = parent;
+    }
+
+    m_nodes[pos] = node;
+    m_position[node.index] = pos;
+}
+
+void IndexedHeap::siftDown(int pos)
+{
+    const int count = int(m_nodes.size());
+    Node node = m_nodes[pos];
+
+    for (;;) {
+        int first = pos * Arity + 1;
+        if (first >= count) break;
+
+        // Ищем минимального из (до) четырех детей
+        int best = first;
+        int last = qMin(first + Arity, count);
+        for (int child = first + 1; child < last; ++child) {
+            if (less(m_nodes[child], m_nodes[best])) best = child;
+        }
+
+        if (!less(m_nodes[best], node)) break;
+
+        m_nodes[pos] = m_nodes[best];
+        m_position[m_nodes[pos].index] = pos;
+        pos = best;
+    }
+
+    m_nodes[pos] = node;
+    m_position[node.index] = pos;
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+// Индексированная 4-арная куча (min-heap) над плотными индексами вершин [0, capacity).
+// Поддерживает уменьшение ключа: для каждой вершины хранится ее позиция в куче,
+// поэтому push() для уже лежащей в куче вершины просто поднимает ее вверх.
+// При равных ключах первой выходит вершина с меньшим индексом.
+class IndexedHeap
+{
+public:
+    explicit IndexedHeap(int capacity = 0);
+
+    // Очистить кучу и подготовить ее под индексы [0, capacity)
+    void reset(int capacity);
+
+    bool isEmpty() const { return m_nodes.empty(); }
+    int size() const { return int(m_nodes.size()); }
+    bool contains(int index) const { return m_position[index] >= 0; }
+
+    // Вставить вершину или уменьшить ее ключ (больший ключ игнорируется)
+    void push(int index, qint64 key);
+
+    // Достать вершину с минимальным ключом
+    int popMin();
+
+    qint64 minKey() const { return m_nodes.front().key; }
+
+private:
+    static constexpr int Arity = 4;
+
+    struct Node {
+        qint64 key;
+        int index;
+    };
+
+    static bool less(const Node& a, const Node& b)
+    {
+        return a.key < b.key || (a.key == b.key && a.index < b.index);
+    }
+
+    void siftUp(int pos);
+    void siftDown(int pos);
+
+    std::vector<Node> m_nodes;     // сама куча: ключ лежит рядом с индексом
+    std::vector<int> m_position;   // индекс вершины -> позиция в m_nodes (-1, если не в куче)
+};
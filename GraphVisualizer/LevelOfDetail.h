@@ -0,0 +1,10 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+// Пороги уровня детализации для отрисовки элементов графа.
+// Уровень - масштаб элемента на экране (QStyleOptionGraphicsItem::levelOfDetailFromTransform):
+// 1.0 - натуральный размер, 0.1 - вершина диаметром 4 пикселя
+static const qreal LabelDetail = 0.5;  // ниже - без подписей (номер вершины, вес ребра)
+static const qreal ShapeDetail = 0.2;  // ниже - без сглаживания: вершина - квадрат, ребро - тонкая линия
+static const qreal PointDetail = 0.075; // ниже - вершина просто заливка в пару пикселей
@@ -0,0 +1,110 @@
+﻿#include "RunMetrics.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+// Версия формата выгрузки: меняется, если поля переименовываются или меняют смысл
+static const int MetricsFormatVersion = 1;
+
+static double perSecond(qint64 count, double ms)
+{
+    return ms > 0 ? count * 1000.0 / ms : 0;
+}
+
+double RunMetrics::solveStepsPerSecond() const
+{
+    return perSecond(steps, solveMs);
+}
+
+double RunMetrics::playStepsPerSecond() const
+{
+    return perSecond(playedSteps, playMs);
+}
+
+QString RunMetrics::summary() const
+{
+    QString text = QString("%1: %2 шагов, трасса %3 КБ")
+        .arg(algorithm)
+        .arg(steps)
+        .arg(traceBytes / 1024.0, 0, 'f', 1);
+
+    if (!loaded) {
+        text += QString(", расчет %1 мс (%2 шагов/с), вершин %3, ребер просмотрено %4")
+            .arg(prepareMs + solveMs, 0, 'f', 1)
+            .arg(solveStepsPerSecond(), 0, 'f', 0)
+            .arg(counters.verticesVisited)
+            .arg(counters.edgeScans);
+        if (counters.relaxations > 0) text += QString(", релаксаций %1").arg(counters.relaxations);
+        if (!completed) text += " (прерван)";
+    }
+
+    if (frames > 0) {
+        text += QString(" | автоплей %1 шагов/с, %2 мс на кадр")
+            .arg(playStepsPerSecond(), 0, 'f', 0)
+            .arg(applyMs / frames, 0, 'f', 2);
+    }
+    return text;
+}
+
+QJsonObject RunMetrics::toJson() const
+{
+    QJsonObject graph;
+    graph["vertices"] = vertices;
+    graph["edges"] = edges;
+
+    QJsonObject solve;
+    solve["loaded"] = loaded;
+    solve["completed"] = completed;
+    solve["prepare_ms"] = prepareMs;
+    solve["solve_ms"] = solveMs;
+    solve["steps"] = steps;
+    solve["steps_per_s"] = solveStepsPerSecond();
+    solve["trace_bytes"] = traceBytes;
+    solve["vertices_visited"] = counters.verticesVisited;
+    solve["edge_scans"] = counters.edgeScans;
+    solve["relaxations"] = counters.relaxations;
+
+    QJsonObject playback;
+    playback["steps"] = playedSteps;
+    playback["frames"] = frames;
+    playback["ms"] = playMs;
+    playback["apply_ms"] = applyMs;
+    playback["steps_per_s"] = playStepsPerSecond();
+
+    QJsonObject run;
+    run["algorithm"] = algorithm;
+    run["started"] = started.toString(Qt::ISODateWithMs);
+    run["graph"] = graph;
+    run["solve"] = solve;
+    run["playback"] = playback;
+    return run;
+}
+
+bool RunMetrics::exportJson(const QString& path, const QList<RunMetrics>& runs, QString* errorString)
+{
+    QJsonArray list;
+    for (const RunMetrics& run : runs) {
+        list.append(run.toJson());
+    }
+
+    QJsonObject root;
+    root["format"] = "graphvisualizer-metrics";
+    root["version"] = MetricsFormatVersion;
+    root["exported"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    root["runs"] = list;
+
+    // Как и файл графа: пишем во временный и подменяем целиком
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (file.write(json) != json.size() || !file.commit()) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
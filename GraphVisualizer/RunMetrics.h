@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <QString>
+#include <QList>
+#include <QDateTime>
+#include <QJsonObject>
+
+#include "StepGenerator.h"
+
+// Метрики одного прогона алгоритма: расчет в рабочем потоке и проигрывание в GUI.
+// Показываются в строке состояния и выгружаются в JSON для сравнения между версиями
+struct RunMetrics
+{
+    QString algorithm;          // имя трассы: "BFS", "Dijkstra", ...
+    QDateTime started;
+    int vertices = 0;
+    int edges = 0;
+
+    // --- Расчет ---
+    bool loaded = false;        // трасса прочитана из файла - расчета не было
+    bool completed = false;     // расчет дошел до конца (не прерван)
+    double prepareMs = 0;       // копия графа и построение CSR (setGraphData)
+    double solveMs = 0;         // выдача всех шагов генератором
+    qint64 steps = 0;
+    qint64 traceBytes = 0;      // AlgorithmTrace::memoryUsage
+    SolverCounters counters;
+
+    // --- Автоплей ---
+    qint64 playedSteps = 0;     // шагов, примененных тиками автоплея
+    qint64 frames = 0;          // тиков автоплея
+    double playMs = 0;          // время, пока автоплей шел
+    double applyMs = 0;         // из него - на свертку шагов и перекраску элементов
+
+    double solveStepsPerSecond() const;
+    double playStepsPerSecond() const;
+
+    // Одна строка для строки состояния
+    QString summary() const;
+
+    QJsonObject toJson() const;
+
+    // Записать прогоны в файл: { "format", "version", "exported", "runs": [...] }
+    static bool exportJson(const QString& path, const QList<RunMetrics>& runs, QString* errorString = nullptr);
+};
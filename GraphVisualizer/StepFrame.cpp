@@ -0,0 +1,83 @@
+﻿#include "StepFrame.h"
+
+#include "VertexItem.h"
+#include "Edge.h"
+
+#include <algorithm>
+
+void StepFrame::nextStamp()
+{
+    // Новая отметка: все прежние перестают действовать (при переполнении - чистим)
+    if (++m_stamp == 0) {
+        std::fill(m_vertexStamp.begin(), m_vertexStamp.end(), 0);
+        std::fill(m_edgeStamp.begin(), m_edgeStamp.end(), 0);
+        m_stamp = 1;
+    }
+}
+
+void StepFrame::begin(int vertexCount, int edgeCount)
+{
+    nextStamp();
+
+    // Реестр мог вырасти с прошлого кадра
+    m_vertexStamp.resize(vertexCount, 0);
+    m_vertexColor.resize(vertexCount);
+    m_edgeStamp.resize(edgeCount, 0);
+    m_edgeColor.resize(edgeCount);
+
+    m_vertices.clear();
+    m_edges.clear();
+    m_reset = false;
+}
+
+void StepFrame::fold(const AlgorithmStep& step)
+{
+    if (step.type == StepType::ResetColors) {
+        // Сброс перекрывает всё, что было раньше в этом кадре
+        m_reset = true;
+        m_vertices.clear();
+        m_edges.clear();
+        nextStamp();
+    }
+    else if (step.type == StepType::HighlightNode) {
+        // Индекс шага - это индекс вершины в GraphStore, он же индекс в реестре вершин
+        if (step.index < 0 || step.index >= int(m_vertexStamp.size())) return;
+
+        if (m_vertexStamp[step.index] != m_stamp) {
+            m_vertexStamp[step.index] = m_stamp;
+            m_vertices.push_back(step.index);
+        }
+        m_vertexColor[step.index] = step.color.rgba();
+    }
+    else if (step.type == StepType::HighlightEdge) {
+        if (step.index < 0 || step.index >= int(m_edgeStamp.size())) return;
+
+        if (m_edgeStamp[step.index] != m_stamp) {
+            m_edgeStamp[step.index] = m_stamp;
+            m_edges.push_back(step.index);
+        }
+        m_edgeColor[step.index] = step.color.rgba();
+    }
+}
+
+void StepFrame::flush(const QList<VertexItem*>& vertices, const QList<Edge*>& edges)
+{
+    if (m_reset) {
+        // Сброс всех цветов (кроме тех, что перекрашены после сброса)
+        for (int i = 0; i < int(vertices.size()); ++i) {
+            if (m_vertexStamp[i] != m_stamp) vertices[i]->setColor(Qt::white);
+        }
+        for (int i = 0; i < int(edges.size()); ++i) {
+            if (m_edgeStamp[i] != m_stamp) edges[i]->setColor(Qt::black);
+        }
+    }
+
+    // Каждый затронутый элемент - одна перекраска, одна заявка на перерисовку.
+    // Сами заявки сцена копит до возврата в цикл событий и рисует кадр целиком
+    for (int i : m_vertices) {
+        vertices[i]->setColor(QColor::fromRgba(m_vertexColor[i]));
+    }
+    for (int i : m_edges) {
+        edges[i]->setColor(QColor::fromRgba(m_edgeColor[i]));
+    }
+}
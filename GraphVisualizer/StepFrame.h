@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include <QColor>
+#include <QList>
+#include <vector>
+
+#include "AlgorithmTrace.h"
+
+class VertexItem;
+class Edge;
+
+// Кадр проигрывания трассы. Шаги кадра сначала сворачиваются в итоговые цвета
+// (последний цвет побеждает), потом каждый затронутый элемент перекрашивается
+// ровно один раз. Индекс шага - позиция элемента в списках, переданных в flush()
+class StepFrame
+{
+public:
+    // Начать кадр для графа такого размера (размер может расти от кадра к кадру)
+    void begin(int vertexCount, int edgeCount);
+
+    void fold(const AlgorithmStep& step);
+
+    // Перекрасить затронутые в кадре элементы
+    void flush(const QList<VertexItem*>& vertices, const QList<Edge*>& edges);
+
+private:
+    void nextStamp();
+
+    std::vector<quint32> m_vertexStamp;   // отметка кадра, в котором элемент уже перекрашен
+    std::vector<quint32> m_edgeStamp;
+    std::vector<QRgb> m_vertexColor;      // итоговый цвет элемента в этом кадре
+    std::vector<QRgb> m_edgeColor;
+    std::vector<int> m_vertices;          // затронутые в кадре элементы
+    std::vector<int> m_edges;
+    quint32 m_stamp = 0;
+    bool m_reset = false;                 // в кадре был сброс цветов
+};
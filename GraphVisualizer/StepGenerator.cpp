@@ -0,0 +1,23 @@
+﻿#include "StepGenerator.h"
+
+bool StepGenerator::next(AlgorithmStep& step)
+{
+    // Порция работы может не дать ни одного шага (например, сосед уже посещен) -
+    // крутим алгоритм, пока шаг не появится или алгоритм не закончится
+    while (m_head == m_count) {
+        if (m_finished) return false;
+
+        m_head = 0;
+        m_count = 0;
+        if (!advance()) m_finished = true;
+    }
+
+    step = m_pending[m_head++];
+    return true;
+}
+
+void StepGenerator::yieldStep(StepType type, int index, const QColor& color)
+{
+    Q_ASSERT(m_count < MaxPending);
+    m_pending[m_count++] = { type, index, color };
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include "AlgorithmTrace.h"
+
+// Счетчики работы алгоритма - для метрик прогона (RunMetrics)
+struct SolverCounters {
+    qint64 verticesVisited = 0; // разобрано вершин (достали из очереди/стека/кучи)
+    qint64 edgeScans = 0;       // просмотрено ребер (соседей в CSR, у Краскала - ребер по весу)
+    qint64 relaxations = 0;     // улучшено расстояний (Дейкстра)
+};
+
+// Алгоритм как возобновляемый генератор шагов (явная машина состояний).
+// next() продвигает алгоритм ровно настолько, чтобы выдать один шаг,
+// поэтому первый шаг доступен сразу, а память ограничена рабочими
+// структурами самого алгоритма, а не длиной всей трассы
+class StepGenerator
+{
+public:
+    virtual ~StepGenerator() = default;
+
+    // Выдать следующий шаг; false - алгоритм закончился
+    bool next(AlgorithmStep& step);
+
+    // Алгоритм закончился и все выданные им шаги уже отданы через next()
+    bool isFinished() const { return m_finished && m_head == m_count; }
+
+    // Грубая оценка продвижения для индикатора: сделано workDone() единиц из workTotal()
+    // (единица - обработанная вершина или ребро, в зависимости от алгоритма)
+    virtual qint64 workDone() const = 0;
+    virtual qint64 workTotal() const = 0;
+
+    const SolverCounters& counters() const { return m_counters; }
+
+protected:
+    // Продвинуть алгоритм на одну порцию работы (одно ребро, одна вершина).
+    // Порция выдает шаги через yieldStep() - не больше MaxPending за раз.
+    // false - алгоритм закончился (выданные в этой порции шаги еще отдадутся)
+    virtual bool advance() = 0;
+
+    void yieldStep(StepType type, int index, const QColor& color);
+
+    SolverCounters m_counters; // алгоритм ведет сам по ходу advance()
+
+private:
+    static constexpr int MaxPending = 4;
+
+    AlgorithmStep m_pending[MaxPending];
+    int m_head = 0;
+    int m_count = 0;
+    bool m_finished = false;
+};
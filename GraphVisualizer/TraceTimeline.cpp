@@ -0,0 +1,115 @@
+﻿#include "TraceTimeline.h"
+
+#include <algorithm>
+
+void TraceTimeline::reset(int vertexCount, int edgeCount)
+{
+    clear();
+
+    m_interval = std::max(MinInterval, qsizetype(vertexCount) + edgeCount);
+    m_vertexColors.assign(vertexCount, 0);
+    m_edgeColors.assign(edgeCount, 0);
+    m_palette.append(0);
+
+    m_checkpoints.push_back({ 0, m_vertexColors, m_edgeColors });
+}
+
+void TraceTimeline::clear()
+{
+    m_checkpoints.clear();
+    m_vertexColors.clear();
+    m_edgeColors.clear();
+    m_processed = 0;
+    m_palette.clear();
+}
+
+void TraceTimeline::extend(const AlgorithmTrace& trace)
+{
+    if (m_checkpoints.empty()) return;
+
+    while (m_processed < trace.size()) {
+        fold(trace.at(m_processed), m_vertexColors, m_edgeColors);
+        m_processed++;
+
+        if (m_processed % m_interval == 0) {
+            m_checkpoints.push_back({ m_processed, m_vertexColors, m_edgeColors });
+        }
+    }
+}
+
+void TraceTimeline::colorsAt(const AlgorithmTrace& trace, qsizetype position,
+    std::vector<QRgb>& vertexColors, std::vector<QRgb>& edgeColors) const
+{
+    if (m_checkpoints.empty()) return;
+
+    // Снимки идут через равные промежутки - нужный находится делением
+    const size_t index = std::min(size_t(position / m_interval), m_checkpoints.size() - 1);
+    const Checkpoint& checkpoint = m_checkpoints[index];
+
+    std::vector<quint8> vertices = checkpoint.vertexColors;
+    std::vector<quint8> edges = checkpoint.edgeColors;
+
+    // Доигрываем от снимка (палитра к этому моменту уже содержит все цвета этих шагов)
+    for (qsizetype i = checkpoint.position; i < position; ++i) {
+        const AlgorithmStep step = trace.at(i);
+        fold(step, step.type == ResetColors ? 0 : findColor(step.color.rgba()), vertices, edges);
+    }
+
+    vertexColors.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertexColors[i] = vertices[i] ? m_palette[vertices[i]] : QColor(Qt::white).rgba();
+    }
+
+    edgeColors.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edgeColors[i] = edges[i] ? m_palette[edges[i]] : QColor(Qt::black).rgba();
+    }
+}
+
+qsizetype TraceTimeline::memoryUsage() const
+{
+    qsizetype bytes = qsizetype(m_checkpoints.capacity() * sizeof(Checkpoint));
+    for (const Checkpoint& checkpoint : m_checkpoints) {
+        bytes += qsizetype(checkpoint.vertexColors.capacity() + checkpoint.edgeColors.capacity());
+    }
+    return bytes + qsizetype(m_vertexColors.capacity() + m_edgeColors.capacity());
+}
+
+quint8 TraceTimeline::findColor(QRgb color) const
+{
+    const int index = int(m_palette.indexOf(color, 1));
+    return quint8(index < 0 ? m_palette.size() - 1 : index);
+}
+
+quint8 TraceTimeline::paletteIndex(QRgb color)
+{
+    int index = int(m_palette.indexOf(color, 1));
+    if (index < 0) {
+        // Как и в AlgorithmTrace: больше 255 цветов не бывает, лишние рисуем последним
+        if (m_palette.size() < 256) {
+            m_palette.append(color);
+        }
+        index = int(m_palette.size()) - 1;
+    }
+    return quint8(index);
+}
+
+void TraceTimeline::fold(const AlgorithmStep& step, std::vector<quint8>& vertexColors, std::vector<quint8>& edgeColors)
+{
+    const quint8 color = step.type == ResetColors ? 0 : paletteIndex(step.color.rgba());
+    fold(step, color, vertexColors, edgeColors);
+}
+
+void TraceTimeline::fold(const AlgorithmStep& step, quint8 color, std::vector<quint8>& vertexColors, std::vector<quint8>& edgeColors)
+{
+    if (step.type == ResetColors) {
+        std::fill(vertexColors.begin(), vertexColors.end(), 0);
+        std::fill(edgeColors.begin(), edgeColors.end(), 0);
+    }
+    else if (step.type == HighlightNode) {
+        if (step.index >= 0 && size_t(step.index) < vertexColors.size()) vertexColors[step.index] = color;
+    }
+    else if (step.type == HighlightEdge) {
+        if (step.index >= 0 && size_t(step.index) < edgeColors.size()) edgeColors[step.index] = color;
+    }
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <QColor>
+#include <QList>
+#include <vector>
+
+#include "AlgorithmTrace.h"
+
+// Шкала времени трассы: периодические снимки цветов всех вершин и ребер.
+// Перейти к любому шагу = взять ближайший снимок слева и доиграть от него
+// не больше interval() шагов, вместо проигрывания трассы с начала
+class TraceTimeline
+{
+public:
+    // Начать новую шкалу для графа такого размера (снимок 0 - цвета по умолчанию)
+    void reset(int vertexCount, int edgeCount);
+    void clear();
+
+    // Досчитать снимки для шагов трассы, появившихся с прошлого вызова
+    void extend(const AlgorithmTrace& trace);
+
+    // Цвета на момент position (применены шаги [0, position)).
+    // Векторы перезаписываются целиком, их можно переиспользовать между вызовами
+    void colorsAt(const AlgorithmTrace& trace, qsizetype position,
+        std::vector<QRgb>& vertexColors, std::vector<QRgb>& edgeColors) const;
+
+    // Расстояние между снимками в шагах
+    qsizetype interval() const { return m_interval; }
+
+    // Сколько байт занимают снимки
+    qsizetype memoryUsage() const;
+
+private:
+    // Цвет хранится номером в палитре шкалы, 0 - цвет по умолчанию
+    // (белый для вершины, черный для ребра), как после ResetColors
+    struct Checkpoint {
+        qsizetype position;
+        std::vector<quint8> vertexColors;
+        std::vector<quint8> edgeColors;
+    };
+
+    // Снимок стоит примерно (V + E) байт, а интервал шагов - 8 байт на шаг,
+    // поэтому интервал не меньше V + E: снимки занимают не больше 1/8 трассы
+    static constexpr qsizetype MinInterval = 4096;
+
+    quint8 paletteIndex(QRgb color);      // найти или добавить
+    quint8 findColor(QRgb color) const;   // только найти (цвет уже встречался)
+    void fold(const AlgorithmStep& step, std::vector<quint8>& vertexColors, std::vector<quint8>& edgeColors);
+    static void fold(const AlgorithmStep& step, quint8 color, std::vector<quint8>& vertexColors, std::vector<quint8>& edgeColors);
+
+    std::vector<Checkpoint> m_checkpoints;
+    qsizetype m_interval = MinInterval;
+
+    // Текущее состояние на конце уже обработанной части трассы
+    std::vector<quint8> m_vertexColors;
+    std::vector<quint8> m_edgeColors;
+    qsizetype m_processed = 0;
+
+    QList<QRgb> m_palette; // m_palette[0] не используется (цвет по умолчанию)
+};
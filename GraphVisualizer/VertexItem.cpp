@@ -1,5 +1,17 @@
 #include "VertexItem.h"
 #include "Edge.h"
+#include "LevelOfDetail.h"
+
+#include <QStyleOptionGraphicsItem>
+#include <QHash>
+#include <QtMath>
+
+// Спрайты используются до такого масштаба; крупнее - вершин на экране мало, рисуем вектором
+static const qreal MaxSpriteDetail = 4.0;
+// Шаг, с которым квантуется масштаб спрайта (1/8 натурального размера)
+static const int SpriteScaleSteps = 8;
+// Предел кэша: цветов у алгоритмов единицы, так что он почти никогда не чистится
+static const int MaxSprites = 512;
 
 
 VertexItem::VertexItem(int id, QPointF position)
@@ -18,31 +30,124 @@ QRectF VertexItem::boundingRect() const
 
 void VertexItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-	Q_UNUSED(option);	//,    , ..    
-	Q_UNUSED(widget);	//   
-	
-	painter->setBrush(m_color);
-	painter->setPen(QPen(Qt::black, 2));
-
-	if (isSelected()) {
-		painter->setPen(QPen(Qt::red, 2));
+	Q_UNUSED(option);	//макросы, чтобы компилятор не ругался, т.к. мы их не используем
+	Q_UNUSED(widget);	//но сигнатура метода фикисирована
+
+	// На мелком масштабе рисуем упрощенно: тысячи вершин по паре пикселей
+	// не отличить от кругов, а сглаживание и текст стоят дорого
+	const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+
+	if (detail < ShapeDetail) {
+		painter->setRenderHint(QPainter::Antialiasing, false);
+		QRectF square(-m_radius, -m_radius, m_radius * 2, m_radius * 2);
+
+		if (detail < PointDetail) {
+			// Точка: белую вершину на белом фоне не видно - рисуем ее черной
+			painter->fillRect(square, isSelected() ? QColor(Qt::red) : (m_color == Qt::white ? QColor(Qt::black) : m_color));
+		}
+		else {
+			painter->setBrush(m_color);
+			painter->setPen(QPen(isSelected() ? Qt::red : Qt::black, 0)); // косметическое перо в 1 пиксель
+			painter->drawRect(square);
+		}
+		return;
+	}
+
+	if (detail <= MaxSpriteDetail) {
+		// Обычный случай: тело вершины - готовая картинка из кэша, рисование = копирование пикселей
+		const qreal scale = qMax(1, qRound(detail * SpriteScaleSteps)) / qreal(SpriteScaleSteps);
+		const qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+		const QPixmap sprite = bodySprite(m_color, isSelected(), m_radius, scale, dpr);
+		painter->drawPixmap(boundingRect(), sprite, QRectF(QPointF(0, 0), QSizeF(sprite.size())));
 	}
+	else {
+		painter->setBrush(m_color);
+		painter->setPen(QPen(Qt::black, 2));
+
+		if (isSelected()) {
+			painter->setPen(QPen(Qt::red, 2));
+		}
+
+		painter->drawEllipse(-m_radius, -m_radius, m_radius * 2, m_radius * 2);
+	}
+
+	if (detail < LabelDetail) return;	//номер уже не прочитать
+
+	if (!m_idValid || painter->font() != m_idFont) {
+		updateIdLabel(painter->font());
+	}
+	painter->setPen(isSelected() ? Qt::red : Qt::black);	//у выделенной вершины номер красный, как обводка
+	painter->drawStaticText(m_idPos, m_idLabel);	//ID будет в центре круга
+}
+
+void VertexItem::updateIdLabel(const QFont& font)
+{
+	m_idFont = font;
+	m_idLabel.setText(QString::number(m_id));
+	m_idLabel.setPerformanceHint(QStaticText::AggressiveCaching);
+	m_idLabel.prepare(QTransform(), font);
+
+	const QSizeF size = m_idLabel.size();
+	m_idPos = QPointF(-size.width() / 2.0, -size.height() / 2.0);
+	m_idValid = true;
+}
+
+QPixmap VertexItem::bodySprite(const QColor& color, bool selected, int radius, qreal scale, qreal dpr)
+{
+	// Ключ: цвет (32 бита) | выделение | радиус | масштаб в шагах | плотность пикселей в четвертях
+	const quint64 key = quint64(color.rgba())
+		| (quint64(selected) << 32)
+		| (quint64(radius & 0x3FF) << 33)
+		| (quint64(qRound(scale * SpriteScaleSteps) & 0xFF) << 43)
+		| (quint64(qRound(dpr * 4) & 0xFF) << 51);
+
+	static QHash<quint64, QPixmap> cache;
+
+	const QPixmap cached = cache.value(key);
+	if (!cached.isNull()) return cached;
+
+	if (cache.size() >= MaxSprites) cache.clear();
+
+	// Рисуем круг один раз в размере, в котором он окажется на экране
+	const qreal side = (radius * 2) + 4;	//как boundingRect
+	const int pixels = qCeil(side * scale * dpr);
 
-	painter->drawEllipse(-m_radius, -m_radius, m_radius * 2, m_radius * 2);
+	QPixmap sprite(pixels, pixels);
+	sprite.setDevicePixelRatio(dpr);
+	sprite.fill(Qt::transparent);
 
-	painter->drawText(boundingRect(), Qt::AlignCenter, QString::number(m_id));	//ID    
+	QPainter painter(&sprite);
+	painter.setRenderHint(QPainter::Antialiasing);
+	painter.scale(scale, scale);
+	painter.translate(side / 2.0, side / 2.0);
+	painter.setBrush(color);
+	painter.setPen(QPen(selected ? Qt::red : Qt::black, 2));
+	painter.drawEllipse(-radius, -radius, radius * 2, radius * 2);
+	painter.end();
+
+	cache.insert(key, sprite);
+	return sprite;
 }
 
 QVariant VertexItem::itemChange(GraphicsItemChange change, const QVariant& value)
 {
-	if (change == ItemPositionChange && scene()) {
+	// Ребра подтягиваются после сдвига и не сразу: каждое встает в очередь один раз
+	// на кадр, даже если двигают сразу оба его конца (перетаскивание выделения)
+	if (change == ItemPositionHasChanged && scene() && m_trackEdges) {
 		for (Edge* edge : edgeList) {
-			edge->adjust();
+			edge->scheduleAdjust();
 		}
 	}
 	return QGraphicsItem::itemChange(change, value);
 }
 
+void VertexItem::setPosBatched(const QPointF& pos)
+{
+	m_trackEdges = false;
+	setPos(pos);
+	m_trackEdges = true;
+}
+
 void VertexItem::addEdge(Edge* edge)
 {
 	edgeList << edge;
@@ -51,23 +156,13 @@ void VertexItem::addEdge(Edge* edge)
 
 void VertexItem::removeEdgeFromList(Edge* edge)
 {
-	// removeOne      
+	// removeOne удаляет первое вхождение элемента из списка
 	edgeList.removeOne(edge);
 }
 
 void VertexItem::setColor(QColor color)
 {
+	if (m_color == color) return; // не просим лишнюю перерисовку
 	m_color = color;
 	update();
-}
-
-bool VertexItem::isConnectedTo(const VertexItem* other) const
-{
-	for (Edge* edge : edgeList) {
-		//     -. ,  .
-		if (edge->sourceNode() == other || edge->destNode() == other) {
-			return true; //   
-		}
-	}
-	return false; //  
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <QBrush>
 #include <QPen>
 #include <QList>
+#include <QPixmap>
+#include <QStaticText>
 
 
 class Edge;
@@ -21,8 +23,11 @@ public:
 	QList<Edge*>& getEdges() { return edgeList; }
 
 	void setColor(QColor color);
+	QColor getColor() const { return m_color; }
 
-	bool isConnectedTo(const VertexItem* other) const;
+	// Сдвинуть без подтягивания ребер: при пакетном переносе многих вершин
+	// вызывающий сам зовет adjust() у каждого ребра один раз на всю пачку
+	void setPosBatched(const QPointF& pos);
 
 	QRectF boundingRect() const override;
 
@@ -34,9 +39,21 @@ protected:
 	QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
 
 private:
-	int m_id;				//  
-	const int m_radius = 20;	// 
+	int m_id;				//Уникальный номер вершины
+	const int m_radius = 20;	//Радиус круга
 	QList<Edge*> edgeList;
 	QColor m_color;
+	bool m_trackEdges = true;	//подтягивать ребра при сдвиге (выключается в setPosBatched)
+
+	// Номер вершины: разметка текста готовится один раз (и при смене шрифта сцены)
+	QStaticText m_idLabel;
+	QFont m_idFont;
+	QPointF m_idPos;		//левый верхний угол текста, чтобы он был по центру круга
+	bool m_idValid = false;
+
+	void updateIdLabel(const QFont& font);
+
+	// Тело вершины (круг с обводкой) из общего кэша спрайтов
+	static QPixmap bodySprite(const QColor& color, bool selected, int radius, qreal scale, qreal dpr);
 };
 
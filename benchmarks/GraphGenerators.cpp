@@ -0,0 +1,129 @@
+﻿#include "GraphGenerators.h"
+
+#include <QtMath>
+#include <random>
+#include <vector>
+
+namespace GraphGenerators {
+
+namespace {
+
+// Средняя степень случайных графов
+const int AverageDegree = 8;
+// Ребер на новую вершину у Барабаши - Альберта (та же средняя степень)
+const int AttachEdges = AverageDegree / 2;
+
+const int MaxWeight = 100;
+
+void addVertices(GraphStore& graph, int count)
+{
+    // Координаты бенчмаркам решателя не нужны - кладем вершины в строку
+    for (int i = 0; i < count; ++i) {
+        graph.addVertex(i + 1, float(i), 0);
+    }
+}
+
+}
+
+QString familyName(Family family)
+{
+    switch (family) {
+    case Family::Grid: return "grid";
+    case Family::ErdosRenyi: return "er";
+    case Family::PowerLaw: return "powerlaw";
+    }
+    return QString();
+}
+
+GraphStore grid(qint64 edgeCount, quint64 seed)
+{
+    // Решетка side x side дает 2 * side * (side - 1) ребер
+    const int side = qMax(2, int(std::sqrt(edgeCount / 2.0)) + 1);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> weight(1, MaxWeight);
+
+    GraphStore graph;
+    graph.reserve(side * side, 2 * side * (side - 1));
+    addVertices(graph, side * side);
+
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            const int v = r * side + c;
+            if (c + 1 < side) graph.addEdge(v, v + 1, weight(rng));
+            if (r + 1 < side) graph.addEdge(v, v + side, weight(rng));
+        }
+    }
+    return graph;
+}
+
+GraphStore erdosRenyi(qint64 edgeCount, quint64 seed)
+{
+    const int vertexCount = int(qMax<qint64>(2, edgeCount * 2 / AverageDegree));
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+    std::uniform_int_distribution<int> weight(1, MaxWeight);
+
+    GraphStore graph;
+    graph.reserve(vertexCount, int(edgeCount));
+    addVertices(graph, vertexCount);
+
+    while (graph.edgeCount() < edgeCount) {
+        const int u = vertex(rng);
+        const int v = vertex(rng);
+        if (u != v) graph.addEdge(u, v, weight(rng));
+    }
+    return graph;
+}
+
+GraphStore powerLaw(qint64 edgeCount, quint64 seed)
+{
+    // Затравочная клика дает AttachEdges * (AttachEdges + 1) / 2 ребер, дальше по AttachEdges на вершину
+    const qint64 seedEdges = AttachEdges * (AttachEdges + 1) / 2;
+    const int vertexCount = int(AttachEdges + 1 + qMax<qint64>(0, (edgeCount - seedEdges + AttachEdges - 1) / AttachEdges));
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> weight(1, MaxWeight);
+
+    GraphStore graph;
+    graph.reserve(vertexCount, int(edgeCount));
+    addVertices(graph, vertexCount);
+
+    // Каждый конец каждого ребра записан в ends: случайный элемент ends -
+    // это вершина, выбранная пропорционально степени
+    std::vector<int> ends;
+    ends.reserve(size_t(edgeCount) * 2);
+
+    // Затравка - клика на первых AttachEdges + 1 вершинах
+    for (int u = 0; u <= AttachEdges; ++u) {
+        for (int v = u + 1; v <= AttachEdges && graph.edgeCount() < edgeCount; ++v) {
+            graph.addEdge(u, v, weight(rng));
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+    }
+
+    for (int v = AttachEdges + 1; v < vertexCount && graph.edgeCount() < edgeCount; ++v) {
+        const size_t existing = ends.size();
+        for (int k = 0; k < AttachEdges && graph.edgeCount() < edgeCount; ++k) {
+            const int u = ends[std::uniform_int_distribution<size_t>(0, existing - 1)(rng)];
+            graph.addEdge(v, u, weight(rng));
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+    }
+    return graph;
+}
+
+GraphStore make(Family family, qint64 edgeCount, quint64 seed)
+{
+    switch (family) {
+    case Family::Grid: return grid(edgeCount, seed);
+    case Family::ErdosRenyi: return erdosRenyi(edgeCount, seed);
+    case Family::PowerLaw: return powerLaw(edgeCount, seed);
+    }
+    return GraphStore();
+}
+
+}
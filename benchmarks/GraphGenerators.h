@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include <QString>
+
+#include "GraphStore.h"
+
+// Синтетические графы для бенчмарков. Размер задается числом ребер,
+// вершины подбираются под семейство. ID вершин - 1..n, веса - 1..100,
+// всё детерминировано по seed
+namespace GraphGenerators {
+
+enum class Family { Grid, ErdosRenyi, PowerLaw };
+
+QString familyName(Family family);
+
+// Квадратная решетка: ~2 ребра на вершину, диаметр ~2*sqrt(n) - длинные "волны" BFS
+GraphStore grid(qint64 edgeCount, quint64 seed = 1);
+
+// G(n, m): m случайных пар вершин, средняя степень ~8, без петель (повторы допускаются)
+GraphStore erdosRenyi(qint64 edgeCount, quint64 seed = 1);
+
+// Барабаши - Альберт: каждая новая вершина цепляет 4 ребра к уже имеющимся
+// пропорционально степени - степени по степенному закону, есть хабы
+GraphStore powerLaw(qint64 edgeCount, quint64 seed = 1);
+
+GraphStore make(Family family, qint64 edgeCount, quint64 seed = 1);
+
+}
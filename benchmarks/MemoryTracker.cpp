@@ -0,0 +1,107 @@
+﻿#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define GV_TRACK_HEAP 1
+#else
+#define GV_TRACK_HEAP 0
+#endif
+
+namespace {
+
+std::atomic<qint64> g_current{ 0 };
+std::atomic<qint64> g_peak{ 0 };
+
+#if GV_TRACK_HEAP
+void trackAlloc(void* p)
+{
+    const qint64 now = g_current.fetch_add(qint64(malloc_usable_size(p)), std::memory_order_relaxed)
+        + qint64(malloc_usable_size(p));
+
+    qint64 peak = g_peak.load(std::memory_order_relaxed);
+    while (now > peak && !g_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+void trackFree(void* p)
+{
+    g_current.fetch_sub(qint64(malloc_usable_size(p)), std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size)
+{
+    void* p = std::malloc(size ? size : 1);
+    if (p) trackAlloc(p);
+    return p;
+}
+
+void release(void* p)
+{
+    if (!p) return;
+    trackFree(p);
+    std::free(p);
+}
+#endif
+
+}
+
+namespace MemoryTracker {
+
+bool isAvailable()
+{
+    return GV_TRACK_HEAP;
+}
+
+qint64 currentBytes()
+{
+    return g_current.load(std::memory_order_relaxed);
+}
+
+qint64 peakBytes()
+{
+    return g_peak.load(std::memory_order_relaxed);
+}
+
+void resetPeak()
+{
+    g_peak.store(g_current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}
+
+#if GV_TRACK_HEAP
+// Выровненные формы (align_val_t) не подменяем: они парные между собой
+// и идут мимо учета; решатель ими не пользуется
+void* operator new(std::size_t size)
+{
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+#endif
@@ -0,0 +1,18 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+// Учет кучи в бенчмарках: MemoryTracker.cpp подменяет глобальные operator new/delete
+// и считает занятые байты (через malloc_usable_size, поэтому только glibc).
+// Решатель и трасса держат данные в std::vector, так что их память видна целиком;
+// контейнеры Qt выделяют память мимо operator new и здесь не учитываются
+namespace MemoryTracker {
+
+bool isAvailable();
+
+// Занято сейчас / максимум с последнего resetPeak()
+qint64 currentBytes();
+qint64 peakBytes();
+void resetPeak();
+
+}
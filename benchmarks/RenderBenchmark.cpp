@@ -0,0 +1,606 @@
+﻿// Бенчмарки отрисовки: сцена из VertexItem/Edge (или VertexItem + EdgeLayer) рисуется
+// через QGraphicsView в QImage на платформе offscreen - дисплей не нужен.
+// Имя бенчмарка - "<что>/<семейство>/<ребра>/<элементов>[/...]", где ребра -
+// "items" (каждое ребро - элемент сцены) или "layer" (все ребра рисует EdgeLayer).
+// Суффикс "/old-edges" - те же ребра, но рисуются как до кэша пера и подписи (LegacyEdge),
+// "/old-vertices" - вершины рисуются как до кэша спрайтов (LegacyVertex):
+// сравнение "до/после" в одной сборке.
+//   Populate   построить сцену из готового графа (как GraphVisualizer::buildScene)
+//   Render     один кадр на масштабе zoom ("fit" - весь граф в окне)
+//   Drag       кадр перетаскивания группы вершин: сдвиг, подтягивание ребер, отрисовка
+//   Replay     кадр автоплея: порция шагов трассы BFS через StepFrame (как в программе), отрисовка
+// Время - на кадр. Счетчики (на кадр): vertex_paints, edge_paints, layer_paints -
+// сколько раз вызван paint() у вершин, отдельных ребер и слоя ребер;
+// vertex_paint_ns, edge_paint_ns - среднее время одного paint() вершины и ребра
+
+#include <benchmark/benchmark.h>
+
+#include <QApplication>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QFontMetrics>
+#include <QtMath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "VertexItem.h"
+#include "Edge.h"
+#include "EdgeLayer.h"
+#include "GraphSolver.h"
+#include "GraphGenerators.h"
+#include "LevelOfDetail.h"
+#include "StepFrame.h"
+
+using GraphGenerators::Family;
+
+namespace {
+
+// Кадр - окно 1280x800, как развернутое окно программы на ноутбуке
+const int FrameWidth = 1280;
+const int FrameHeight = 800;
+
+// Шаг раскладки: вершины радиусом 20 не касаются друг друга
+const qreal Spacing = 80;
+
+// Перетаскиваемая группа и ее сдвиг за кадр (туда и обратно, чтобы не уезжала)
+const int DragVertices = 50;
+const QPointF DragStep(3, 2);
+
+// Шагов трассы на кадр автоплея (~3000 шагов/с при 30 кадрах/с)
+const int StepsPerFrame = 100;
+
+enum class EdgeMode { Items, Layer };
+
+// Как рисуются элементы: рабочим кодом или так, как до кэшей отрисовки
+enum class Painting { Cached, OldEdges, OldVertices };
+
+const Family Families[] = { Family::Grid, Family::ErdosRenyi };
+const EdgeMode EdgeModes[] = { EdgeMode::Items, EdgeMode::Layer };
+// Элементов сцены (вершин + ребер). 30 тыс. - решетка из 10 тыс. вершин
+const qint64 ItemCounts[] = { 1000, 10000, 30000, 200000 };
+// Масштабы вокруг порогов LevelOfDetail.h: точки, квадраты, спрайты без подписей, всё с подписями.
+// 0 - вписать граф в окно
+const qreal Zooms[] = { 0, 0.05, 0.15, 0.35, 1.0 };
+
+// --- Подсчет вызовов paint() ---
+// Элементы бенчмарка - наследники рабочих классов, которые считают вызовы и их время
+struct PaintCounts {
+    qint64 vertices = 0;
+    qint64 edges = 0;
+    qint64 layers = 0;
+    qint64 vertexNs = 0;
+    qint64 edgeNs = 0;
+};
+PaintCounts paints;
+QElapsedTimer paintClock;
+
+class CountedVertex : public VertexItem
+{
+public:
+    using VertexItem::VertexItem;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override
+    {
+        ++paints.vertices;
+        const qint64 start = paintClock.nsecsElapsed();
+        paintVertex(painter, option, widget);
+        paints.vertexNs += paintClock.nsecsElapsed() - start;
+    }
+
+protected:
+    virtual void paintVertex(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+    {
+        VertexItem::paint(painter, option, widget);
+    }
+};
+
+// Вершина, которая рисуется как до кэша спрайтов: круг со сглаживанием вектором
+// и номер через drawText на каждый paint(). Мелкие масштабы (квадраты и точки)
+// спрайтов не используют - там рисует рабочий код
+class LegacyVertex : public CountedVertex
+{
+public:
+    using CountedVertex::CountedVertex;
+
+protected:
+    void paintVertex(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override
+    {
+        const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        if (detail < ShapeDetail) {
+            VertexItem::paint(painter, option, widget);
+            return;
+        }
+
+        painter->setBrush(getColor());
+        painter->setPen(QPen(isSelected() ? Qt::red : Qt::black, 2));
+        painter->drawEllipse(boundingRect().adjusted(2, 2, -2, -2)); // boundingRect - круг плюс 2 на обводку
+
+        if (detail < LabelDetail) return;
+
+        painter->drawText(boundingRect(), Qt::AlignCenter, QString::number(getId()));
+    }
+};
+
+class CountedEdge : public Edge
+{
+public:
+    using Edge::Edge;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override
+    {
+        ++paints.edges;
+        const qint64 start = paintClock.nsecsElapsed();
+        paintEdge(painter, option, widget);
+        paints.edgeNs += paintClock.nsecsElapsed() - start;
+    }
+
+protected:
+    virtual void paintEdge(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+    {
+        Edge::paint(painter, option, widget);
+    }
+};
+
+// Ребро, которое рисуется как до кэша: перо, метрики шрифта, текст веса и жирный шрифт
+// собираются заново на каждый paint(). Уровни детализации - как у рабочего Edge,
+// так что на любом масштабе разница - только в кэше
+class LegacyEdge : public CountedEdge
+{
+public:
+    using CountedEdge::CountedEdge;
+
+protected:
+    void paintEdge(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) override
+    {
+        const QLineF line(sourceNode()->pos(), destNode()->pos());
+        if (qFuzzyCompare(line.length(), qreal(0.))) return;
+
+        const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        if (detail < ShapeDetail) {
+            painter->setRenderHint(QPainter::Antialiasing, false);
+            painter->setPen(QPen(getColor(), 0));
+            painter->drawLine(line);
+            return;
+        }
+
+        painter->setPen(QPen(getColor(), 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        painter->drawLine(line);
+
+        if (detail < LabelDetail) return;
+
+        const QPointF center = line.center();
+        const QString text = QString::number(getWeight());
+
+        QFontMetrics fm(painter->font());
+        const int textWidth = fm.horizontalAdvance(text);
+        const int textHeight = fm.height();
+        const QRectF textRect(center.x() - textWidth / 2.0 - 4, center.y() - textHeight / 2.0,
+            textWidth + 8, textHeight);
+
+        painter->fillRect(textRect, QColor(255, 255, 255, 200));
+        QFont font = painter->font();
+        font.setBold(true);
+        painter->setFont(font);
+        painter->setPen(Qt::blue);
+        painter->drawText(textRect, Qt::AlignCenter, text);
+    }
+};
+
+class CountedLayer : public EdgeLayer
+{
+public:
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override
+    {
+        ++paints.layers;
+        EdgeLayer::paint(painter, option, widget);
+    }
+};
+
+const char* modeName(EdgeMode mode)
+{
+    return mode == EdgeMode::Items ? "items" : "layer";
+}
+
+// Суффикс имени бенчмарка (у рабочей отрисовки его нет)
+std::string paintingSuffix(Painting painting)
+{
+    switch (painting) {
+    case Painting::OldEdges: return "/old-edges";
+    case Painting::OldVertices: return "/old-vertices";
+    default: return "";
+    }
+}
+
+// Граф семейства, в котором вершин + ребер примерно itemCount, с координатами
+GraphStore makeGraph(Family family, qint64 itemCount)
+{
+    // Решетка: ~2 ребра на вершину, случайный граф: ~4 (средняя степень 8)
+    const qint64 edgesPerVertex = family == Family::Grid ? 2 : 4;
+    GraphStore graph = GraphGenerators::make(family, itemCount * edgesPerVertex / (edgesPerVertex + 1));
+
+    const int n = graph.vertexCount();
+    const int side = qMax(1, int(std::ceil(std::sqrt(double(n)))));
+
+    if (family == Family::Grid) {
+        // Вершины решетки идут по строкам - ставим их в узлы решетки
+        for (int i = 0; i < n; ++i) {
+            graph.vertices[i].x = float((i % side) * Spacing);
+            graph.vertices[i].y = float((i / side) * Spacing);
+        }
+    }
+    else {
+        // Случайные точки в квадрате той же площади: ребра длинные и пересекаются
+        std::mt19937_64 rng(1);
+        std::uniform_real_distribution<float> coord(0, float(side * Spacing));
+        for (GraphVertex& v : graph.vertices) {
+            v.x = coord(rng);
+            v.y = coord(rng);
+        }
+    }
+    return graph;
+}
+
+// Сцена с видом, собранная из графа так же, как это делает GraphVisualizer
+class GraphScene
+{
+public:
+    GraphScene(const GraphStore& graph, EdgeMode mode, Painting painting = Painting::Cached)
+    {
+        scene.setBackgroundBrush(Qt::white);
+
+        view.setScene(&scene);
+        view.setRenderHint(QPainter::Antialiasing);
+        view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        view.setFrameShape(QFrame::NoFrame);
+        view.resize(FrameWidth, FrameHeight);
+
+        // Пакетом, как buildScene: индекс сцены строится один раз в конце
+        scene.setItemIndexMethod(QGraphicsScene::NoIndex);
+
+        if (mode == EdgeMode::Layer) {
+            layer = new CountedLayer();
+            scene.addItem(layer);
+        }
+
+        QRectF bounds;
+        vertices.reserve(graph.vertexCount());
+        for (const GraphVertex& gv : graph.vertices) {
+            const QPointF position(gv.x, gv.y);
+            VertexItem* v = painting == Painting::OldVertices ? new LegacyVertex(gv.id, position) : new CountedVertex(gv.id, position);
+            scene.addItem(v);
+            vertices.push_back(v);
+            bounds |= QRectF(position, QSizeF(1, 1));
+        }
+
+        // В режиме слоя линии уходят в слой одной пачкой, как в GraphVisualizer::createLayerEdges
+        int firstSlot = 0;
+        if (layer) {
+            std::vector<QLineF> lines;
+            lines.reserve(graph.edgeCount());
+            for (const GraphEdge& ge : graph.edges) {
+                lines.emplace_back(vertices[ge.source]->pos(), vertices[ge.target]->pos());
+            }
+            firstSlot = layer->addEdges(lines.data(), int(lines.size()), QColor(Qt::black));
+        }
+
+        edges.reserve(graph.edgeCount());
+        for (const GraphEdge& ge : graph.edges) {
+            VertexItem* a = vertices[ge.source];
+            VertexItem* b = vertices[ge.target];
+
+            Edge* e = painting == Painting::OldEdges ? new LegacyEdge(a, b) : new CountedEdge(a, b);
+            e->setWeight(ge.weight);
+
+            if (layer) {
+                e->attachToLayer(layer, firstSlot + int(edges.size()));
+                a->getEdges().append(e);
+                if (b != a) b->getEdges().append(e);
+            }
+            else {
+                a->addEdge(e);
+                if (b != a) b->addEdge(e);
+                scene.addItem(e);
+            }
+            edges.push_back(e);
+        }
+
+        scene.setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+        scene.setSceneRect(bounds.adjusted(-50, -50, 50, 50) | QRectF(0, 0, 800, 600));
+    }
+
+    ~GraphScene()
+    {
+        // Ребра слоя не в сцене - удаляем сами, пока жив слой
+        if (layer) qDeleteAll(edges);
+    }
+
+    // Построить индекс сцены сейчас (обычно его строит первый запрос к сцене)
+    void buildIndex()
+    {
+        benchmark::DoNotOptimize(scene.items(scene.sceneRect().center()));
+    }
+
+    // Встать на масштаб (0 - вписать граф) с центром в точке center
+    void setZoom(qreal zoom, const QPointF& center)
+    {
+        if (zoom > 0) {
+            view.setTransform(QTransform::fromScale(zoom, zoom));
+            view.centerOn(center);
+        }
+        else {
+            view.fitInView(scene.sceneRect(), Qt::KeepAspectRatio);
+        }
+    }
+
+    // Один кадр: сначала отложенная работа цикла событий (adjust() ребер,
+    // обработка грязных элементов), потом полная отрисовка окна
+    void renderFrame()
+    {
+        QCoreApplication::processEvents();
+        view.viewport()->render(&frame);
+    }
+
+    QGraphicsScene scene;
+    QGraphicsView view;
+    EdgeLayer* layer = nullptr;
+    // Списки - как реестр GraphVisualizer: их же получает StepFrame
+    QList<VertexItem*> vertices;
+    QList<Edge*> edges;
+
+    QImage frame{ FrameWidth, FrameHeight, QImage::Format_ARGB32_Premultiplied };
+};
+
+// Текущая сцена. Бенчмарки зарегистрированы подряд по сценам,
+// поэтому каждая сцена строится один раз на все замеры
+struct Fixture {
+    Family family = Family::Grid;
+    EdgeMode mode = EdgeMode::Items;
+    Painting painting = Painting::Cached;
+    qint64 requestedItems = -1;
+    GraphStore graph;
+    std::unique_ptr<GraphScene> scene;
+    std::unique_ptr<GraphSolver> solver;  // для трассы автоплея
+};
+
+Fixture current;
+
+Fixture& fixture(Family family, EdgeMode mode, qint64 itemCount, Painting painting = Painting::Cached)
+{
+    if (current.family != family || current.mode != mode || current.requestedItems != itemCount
+        || current.painting != painting) {
+        current.scene.reset();
+        current.solver.reset();
+        current.graph = makeGraph(family, itemCount);
+        current.family = family;
+        current.mode = mode;
+        current.painting = painting;
+        current.requestedItems = itemCount;
+
+        current.scene = std::make_unique<GraphScene>(current.graph, mode, painting);
+        current.scene->buildIndex();
+        current.scene->view.show();
+    }
+    return current;
+}
+
+// Элементы и вид должны умереть раньше QApplication
+void releaseFixture()
+{
+    current.scene.reset();
+    current.solver.reset();
+}
+
+void setSceneCounters(benchmark::State& state, const Fixture& f)
+{
+    state.counters["vertices"] = f.graph.vertexCount();
+    state.counters["edges"] = f.graph.edgeCount();
+}
+
+void setPaintCounters(benchmark::State& state, const PaintCounts& counts)
+{
+    state.counters["vertex_paints"] = benchmark::Counter(double(counts.vertices), benchmark::Counter::kAvgIterations);
+    state.counters["edge_paints"] = benchmark::Counter(double(counts.edges), benchmark::Counter::kAvgIterations);
+    state.counters["layer_paints"] = benchmark::Counter(double(counts.layers), benchmark::Counter::kAvgIterations);
+    state.counters["vertex_paint_ns"] = counts.vertices > 0 ? double(counts.vertexNs) / counts.vertices : 0.0;
+    state.counters["edge_paint_ns"] = counts.edges > 0 ? double(counts.edgeNs) / counts.edges : 0.0;
+}
+
+// Центр графа: туда смотрит камера у Render и Drag
+QPointF graphCenter(const GraphScene& s)
+{
+    const VertexItem* middle = s.vertices[s.vertices.size() / 2];
+    return middle->pos();
+}
+
+void benchmarkPopulate(benchmark::State& state, Family family, EdgeMode mode, qint64 itemCount)
+{
+    const GraphStore graph = makeGraph(family, itemCount);
+
+    for (auto _ : state) {
+        auto scene = std::make_unique<GraphScene>(graph, mode);
+        scene->buildIndex();
+
+        // Разбор сцены не меряем
+        state.PauseTiming();
+        scene.reset();
+        state.ResumeTiming();
+    }
+
+    state.counters["vertices"] = graph.vertexCount();
+    state.counters["edges"] = graph.edgeCount();
+}
+
+void benchmarkRender(benchmark::State& state, Family family, EdgeMode mode, qint64 itemCount, qreal zoom, Painting painting)
+{
+    Fixture& f = fixture(family, mode, itemCount, painting);
+    GraphScene& s = *f.scene;
+
+    s.setZoom(zoom, graphCenter(s));
+    s.renderFrame(); // прогрев: подписи и спрайты готовятся при первой отрисовке
+
+    paints = PaintCounts();
+    for (auto _ : state) {
+        s.renderFrame();
+    }
+
+    setSceneCounters(state, f);
+    setPaintCounters(state, paints);
+    state.counters["zoom"] = s.view.transform().m11();
+}
+
+void benchmarkDrag(benchmark::State& state, Family family, EdgeMode mode, qint64 itemCount)
+{
+    Fixture& f = fixture(family, mode, itemCount);
+    GraphScene& s = *f.scene;
+
+    // Группа - вершины подряд от середины реестра (у решетки это кусок строки)
+    const qsizetype first = s.vertices.size() / 2;
+    const qsizetype last = qMin(s.vertices.size(), first + DragVertices);
+
+    s.setZoom(1.0, graphCenter(s));
+    s.renderFrame();
+
+    paints = PaintCounts();
+    qint64 frame = 0;
+    for (auto _ : state) {
+        // Так сдвигает выделение QGraphicsScene при перетаскивании: setPos каждой вершине
+        const QPointF delta = (frame++ & 1) ? -DragStep : DragStep;
+        for (qsizetype i = first; i < last; ++i) {
+            s.vertices[i]->setPos(s.vertices[i]->pos() + delta);
+        }
+        s.renderFrame();
+    }
+
+    // Группа возвращается на место (число кадров могло быть нечетным)
+    if (frame & 1) {
+        for (qsizetype i = first; i < last; ++i) {
+            s.vertices[i]->setPos(s.vertices[i]->pos() - DragStep);
+        }
+        s.renderFrame();
+    }
+
+    setSceneCounters(state, f);
+    setPaintCounters(state, paints);
+    state.counters["dragged"] = double(last - first);
+}
+
+// Вернуть исходные цвета (как шаг ResetColors)
+void resetColors(GraphScene& s)
+{
+    for (VertexItem* v : s.vertices) v->setColor(Qt::white);
+    for (Edge* e : s.edges) e->setColor(Qt::black);
+}
+
+void benchmarkReplay(benchmark::State& state, Family family, EdgeMode mode, qint64 itemCount, Painting painting)
+{
+    Fixture& f = fixture(family, mode, itemCount, painting);
+    GraphScene& s = *f.scene;
+
+    if (!f.solver) {
+        f.solver = std::make_unique<GraphSolver>();
+        f.solver->setGraphData(f.graph);
+    }
+    const AlgorithmTrace trace = f.solver->runBFS(f.graph.vertices.front().id);
+
+    s.setZoom(0, QPointF());
+    resetColors(s);
+    s.renderFrame();
+
+    StepFrame frame;
+    paints = PaintCounts();
+    qsizetype cursor = 0;
+    for (auto _ : state) {
+        // Трасса кончилась - начинаем сначала (перекраска в исходные цвета не в замере)
+        if (cursor >= trace.size()) {
+            state.PauseTiming();
+            resetColors(s);
+            s.renderFrame();
+            cursor = 0;
+            state.ResumeTiming();
+        }
+
+        // Порция шагов кадра - тем же путем, что GraphVisualizer::applySteps:
+        // шаги сворачиваются в итоговые цвета, каждый элемент перекрашивается один раз
+        const qsizetype end = qMin(trace.size(), cursor + StepsPerFrame);
+        frame.begin(int(s.vertices.size()), int(s.edges.size()));
+        for (; cursor < end; ++cursor) {
+            frame.fold(trace.at(cursor));
+        }
+        frame.flush(s.vertices, s.edges);
+        s.renderFrame();
+    }
+
+    resetColors(s);
+
+    setSceneCounters(state, f);
+    setPaintCounters(state, paints);
+    state.counters["steps"] = double(trace.size());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // Без дисплея: если платформа не задана явно, рисуем в память
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    paintClock.start();
+
+    for (Family family : Families) {
+        for (EdgeMode mode : EdgeModes) {
+            for (qint64 itemCount : ItemCounts) {
+                const std::string suffix = "/" + GraphGenerators::familyName(family).toStdString()
+                    + "/" + modeName(mode) + "/" + std::to_string(itemCount);
+
+                benchmark::RegisterBenchmark(("Populate" + suffix).c_str(),
+                    [family, mode, itemCount](benchmark::State& state) { benchmarkPopulate(state, family, mode, itemCount); })
+                    ->Unit(benchmark::kMillisecond)
+                    ->UseRealTime();
+
+                // Ребра по-старому - только там, где они рисуются сами, а не слоем
+                for (Painting painting : { Painting::Cached, Painting::OldEdges }) {
+                    if (painting == Painting::OldEdges && mode != EdgeMode::Items) continue;
+
+                    for (qreal zoom : Zooms) {
+                        const std::string zoomName = zoom > 0 ? QString::number(zoom).toStdString() : "fit";
+                        benchmark::RegisterBenchmark(("Render" + suffix + "/zoom:" + zoomName + paintingSuffix(painting)).c_str(),
+                            [family, mode, itemCount, zoom, painting](benchmark::State& state) {
+                                benchmarkRender(state, family, mode, itemCount, zoom, painting);
+                            })
+                            ->Unit(benchmark::kMillisecond)
+                            ->UseRealTime();
+                    }
+                }
+
+                benchmark::RegisterBenchmark(("Drag" + suffix).c_str(),
+                    [family, mode, itemCount](benchmark::State& state) { benchmarkDrag(state, family, mode, itemCount); })
+                    ->Unit(benchmark::kMillisecond)
+                    ->UseRealTime();
+
+                for (Painting painting : { Painting::Cached, Painting::OldVertices }) {
+                    benchmark::RegisterBenchmark(("Replay" + suffix + paintingSuffix(painting)).c_str(),
+                        [family, mode, itemCount, painting](benchmark::State& state) {
+                            benchmarkReplay(state, family, mode, itemCount, painting);
+                        })
+                        ->Unit(benchmark::kMillisecond)
+                        ->UseRealTime();
+                }
+            }
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    releaseFixture();
+    return 0;
+}
@@ -0,0 +1,211 @@
+﻿// Бенчмарки решателя без GUI: каждый алгоритм на каждом семействе графов
+// от 1 тыс. до 10 млн ребер. Имя бенчмарка - "<алгоритм>/<семейство>/<ребер>".
+// Кроме времени выводятся счетчики:
+//   steps          шагов в трассе
+//   steps_per_s    шагов в секунду
+//   trace_MB       память трассы (AlgorithmTrace::memoryUsage)
+//   peak_heap_MB   пик кучи за прогон сверх того, что было до него (MemoryTracker)
+// Open - открыть граф, сохраненный в .gvg: отобразить файл и поставить решатель
+// прямо на его страницы (setGraphView, без копии массивов); file_MB - размер файла
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "GraphSolver.h"
+#include "GraphFile.h"
+#include "GraphGenerators.h"
+#include "MemoryTracker.h"
+
+using GraphGenerators::Family;
+
+namespace {
+
+const double MiB = 1024.0 * 1024.0;
+
+// Что измеряем. Другой бэкенд решателя сравнивается добавлением строки сюда:
+// имя и функция, которая строит полную трассу на готовом решателе
+struct Algorithm {
+    const char* name;
+    std::function<AlgorithmTrace(GraphSolver& solver, int startId)> run;
+};
+
+const Algorithm Algorithms[] = {
+    { "BFS", [](GraphSolver& solver, int startId) { return solver.runBFS(startId); } },
+    // Параллельный BFS по уровням: только уровни и родители (шагов 0) / вместе с трассой
+    { "ParallelBFS", [](GraphSolver& solver, int startId) {
+        benchmark::DoNotOptimize(solver.runParallelBFS(startId).depth);
+        return AlgorithmTrace();
+    } },
+    { "ParallelBFS+trace", [](GraphSolver& solver, int startId) { return solver.runParallelBFS(startId, true).trace; } },
+    { "DFS", [](GraphSolver& solver, int startId) { return solver.runDFS(startId); } },
+    { "Dijkstra", [](GraphSolver& solver, int startId) { return solver.runDijkstra(startId); } },
+    // Delta-stepping с автоматической шириной корзины: только расстояния / вместе с трассой
+    { "DeltaStepping", [](GraphSolver& solver, int startId) {
+        benchmark::DoNotOptimize(solver.runDeltaStepping(startId).buckets);
+        return AlgorithmTrace();
+    } },
+    { "DeltaStepping+trace", [](GraphSolver& solver, int startId) { return solver.runDeltaStepping(startId, 0, true).trace; } },
+    { "Components", [](GraphSolver& solver, int) { return solver.runConnectedComponents(); } },
+    { "ParallelComponents", [](GraphSolver& solver, int) {
+        benchmark::DoNotOptimize(solver.runParallelComponents().count);
+        return AlgorithmTrace();
+    } },
+    { "ParallelComponents+trace", [](GraphSolver& solver, int) { return solver.runParallelComponents(true).trace; } },
+    { "Kruskal", [](GraphSolver& solver, int) { return solver.runKruskal(); } },
+};
+
+const Family Families[] = { Family::Grid, Family::ErdosRenyi, Family::PowerLaw };
+const qint64 EdgeCounts[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+// Текущий граф с готовым решателем. Бенчмарки зарегистрированы подряд по графам,
+// поэтому каждый граф генерируется (и CSR строится) один раз на все алгоритмы
+struct Fixture {
+    Family family = Family::Grid;
+    qint64 requestedEdges = -1;
+    GraphStore graph;              // копия для бенчмарка подготовки
+    std::unique_ptr<GraphSolver> solver;
+};
+
+Fixture& fixture(Family family, qint64 edgeCount)
+{
+    static Fixture current;
+    if (current.family != family || current.requestedEdges != edgeCount) {
+        current.solver.reset();
+        current.graph = GraphGenerators::make(family, edgeCount);
+        current.family = family;
+        current.requestedEdges = edgeCount;
+
+        current.solver = std::make_unique<GraphSolver>();
+        current.solver->setGraphData(current.graph);
+    }
+    return current;
+}
+
+void setGraphCounters(benchmark::State& state, const Fixture& f)
+{
+    state.counters["vertices"] = f.graph.vertexCount();
+    state.counters["edges"] = f.graph.edgeCount();
+}
+
+// Подготовка решателя: копия графа и построение смежности
+void benchmarkSetup(benchmark::State& state, Family family, qint64 edgeCount)
+{
+    const Fixture& f = fixture(family, edgeCount);
+
+    qint64 peak = 0;
+    for (auto _ : state) {
+        MemoryTracker::resetPeak();
+        const qint64 baseline = MemoryTracker::currentBytes();
+
+        GraphSolver solver;
+        solver.setGraphData(f.graph);
+        benchmark::DoNotOptimize(solver.graph().vertices);
+
+        peak = qMax(peak, MemoryTracker::peakBytes() - baseline);
+    }
+
+    setGraphCounters(state, f);
+    if (MemoryTracker::isAvailable()) state.counters["peak_heap_MB"] = peak / MiB;
+}
+
+// Открытие сохраненного графа: проверка и отображение файла, затем смежность решателя.
+// Файл пишется один раз до замера, поэтому он уже в кэше страниц - как при повторном открытии
+void benchmarkOpen(benchmark::State& state, Family family, qint64 edgeCount)
+{
+    const Fixture& f = fixture(family, edgeCount);
+
+    static QTemporaryDir directory;
+    const QString path = directory.filePath("graph.gvg");
+    QString error;
+    if (!GraphFile::save(path, f.graph.view(), {}, &error)) {
+        state.SkipWithError(error.toStdString().c_str());
+        return;
+    }
+
+    qint64 peak = 0;
+    for (auto _ : state) {
+        MemoryTracker::resetPeak();
+        const qint64 baseline = MemoryTracker::currentBytes();
+
+        GraphFile file;
+        if (!file.open(path)) {
+            state.SkipWithError(file.errorString().toStdString().c_str());
+            break;
+        }
+        GraphSolver solver;
+        solver.setGraphView(file.graph());
+        benchmark::DoNotOptimize(solver.graph().vertices);
+
+        peak = qMax(peak, MemoryTracker::peakBytes() - baseline);
+    }
+
+    setGraphCounters(state, f);
+    state.counters["file_MB"] = QFileInfo(path).size() / MiB;
+    if (MemoryTracker::isAvailable()) state.counters["peak_heap_MB"] = peak / MiB;
+}
+
+void benchmarkAlgorithm(benchmark::State& state, Family family, qint64 edgeCount, const Algorithm& algorithm)
+{
+    Fixture& f = fixture(family, edgeCount);
+    const int startId = f.graph.vertices.front().id;
+
+    qint64 steps = 0;
+    qint64 traceBytes = 0;
+    qint64 peak = 0;
+    for (auto _ : state) {
+        MemoryTracker::resetPeak();
+        const qint64 baseline = MemoryTracker::currentBytes();
+
+        const AlgorithmTrace trace = algorithm.run(*f.solver, startId);
+        steps = trace.size();
+        traceBytes = trace.memoryUsage();
+
+        peak = qMax(peak, MemoryTracker::peakBytes() - baseline);
+    }
+
+    setGraphCounters(state, f);
+    state.counters["steps"] = double(steps);
+    state.counters["steps_per_s"] = benchmark::Counter(double(steps) * state.iterations(), benchmark::Counter::kIsRate);
+    state.counters["trace_MB"] = traceBytes / MiB;
+    if (MemoryTracker::isAvailable()) state.counters["peak_heap_MB"] = peak / MiB;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    for (Family family : Families) {
+        for (qint64 edgeCount : EdgeCounts) {
+            const std::string suffix = "/" + GraphGenerators::familyName(family).toStdString() + "/" + std::to_string(edgeCount);
+
+            benchmark::RegisterBenchmark(("Setup" + suffix).c_str(),
+                [family, edgeCount](benchmark::State& state) { benchmarkSetup(state, family, edgeCount); })
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+
+            benchmark::RegisterBenchmark(("Open" + suffix).c_str(),
+                [family, edgeCount](benchmark::State& state) { benchmarkOpen(state, family, edgeCount); })
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+
+            for (const Algorithm& algorithm : Algorithms) {
+                benchmark::RegisterBenchmark((algorithm.name + suffix).c_str(),
+                    [family, edgeCount, &algorithm](benchmark::State& state) { benchmarkAlgorithm(state, family, edgeCount, algorithm); })
+                    ->Unit(benchmark::kMillisecond)
+                    ->UseRealTime();
+            }
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}